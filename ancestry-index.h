@@ -0,0 +1,197 @@
+#pragma once
+
+#include "general-tree.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Ancestor and lowest-common-ancestor queries over a general_tree.
+ *
+ * Building the index numbers the nodes in pre-order, so a node is an ancestor of every node whose number falls
+ * inside its subtree range, which answers is_ancestor() in O(1). For two nodes numbered u < v, the shallowest node
+ * numbered in (u, v] is a child of their lowest common ancestor: a sparse table over the pre-order depths finds it in
+ * O(1), at the cost of O(n log n) memory.
+ *
+ * The index is a snapshot: any structural change of the tree (insertions, deletions, clear, assignments) invalidates
+ * it, and rebuild() must be called before querying again. Nodes inserted after the index was built are rejected,
+ * but a deleted node's slot may be reused by a later insertion, so mixing queries and mutations is undefined.
+ */
+template <typename Tree>
+class ancestry_index
+{
+public:
+    using node = typename Tree::node;
+    using index_type = std::uint32_t;
+
+private:
+    static constexpr index_type null_index = std::numeric_limits<index_type>::max();
+
+    std::unordered_map<const void*, index_type> m_ids;
+    std::vector<node> m_nodes;
+    std::vector<index_type> m_parent;
+    std::vector<index_type> m_depth;
+    std::vector<index_type> m_subtree_size;
+
+    // m_sparse[k][i] is the shallowest node numbered in [i, i + 2^(k + 1))
+    std::vector<std::vector<index_type>> m_sparse;
+
+public:
+    ancestry_index() = default;
+
+    /**
+     * @brief Builds the index over the current shape of the given tree.
+     * @throws std::length_error If the tree has more nodes than 32-bit indices can address.
+     */
+    explicit ancestry_index(const Tree& tree)
+    {
+        rebuild(tree);
+    }
+
+    /**
+     * @brief Discards the index and builds it again over the current shape of the given tree, in O(n log n).
+     * @throws std::length_error If the tree has more nodes than 32-bit indices can address.
+     */
+    void rebuild(const Tree& tree)
+    {
+        clear();
+
+        for (auto it = tree.preorder_begin(); it != tree.preorder_end(); ++it)
+        {
+            if (m_nodes.size() >= null_index)
+                throw std::length_error("Tree too large to be indexed");
+
+            node n = it.get_node();
+            const index_type id = static_cast<index_type>(m_nodes.size());
+            const index_type parent = n.is_root() ? null_index : m_ids.at(n.parent().m_node);
+
+            m_ids.emplace(n.m_node, id);
+            m_nodes.push_back(n);
+            m_parent.push_back(parent);
+            m_depth.push_back(parent == null_index ? 0 : m_depth[parent] + 1);
+        }
+
+        if (m_nodes.empty())
+            return;
+
+        // children come after their parent, a reverse scan accumulates every subtree
+        const std::size_t size = m_nodes.size();
+        m_subtree_size.assign(size, 1);
+        for (std::size_t i = size - 1; i > 0; i--)
+            m_subtree_size[m_parent[i]] += m_subtree_size[i];
+
+        for (std::size_t width = 2; width <= size; width *= 2)
+        {
+            const std::vector<index_type>* previous = m_sparse.empty() ? nullptr : &m_sparse.back();
+            std::vector<index_type> level(size - width + 1);
+            for (std::size_t i = 0; i < level.size(); i++)
+            {
+                const index_type left = previous ? (*previous)[i] : static_cast<index_type>(i);
+                const index_type right = previous ? (*previous)[i + width / 2] : static_cast<index_type>(i + 1);
+                level[i] = shallower(left, right);
+            }
+            m_sparse.push_back(std::move(level));
+        }
+    }
+
+    /**
+     * @brief Discards the index, leaving it empty.
+     */
+    void clear() noexcept
+    {
+        m_ids.clear();
+        m_nodes.clear();
+        m_parent.clear();
+        m_depth.clear();
+        m_subtree_size.clear();
+        m_sparse.clear();
+    }
+
+    /**
+     * @brief Checks whether the index holds no nodes.
+     */
+    bool empty() const noexcept
+    {
+        return m_nodes.empty();
+    }
+
+    /**
+     * @brief Returns the number of indexed nodes.
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_nodes.size();
+    }
+
+    /**
+     * @brief Checks whether the given node was part of the tree when the index was built.
+     */
+    [[nodiscard]] bool contains(node n) const
+    {
+        return !n.is_null() && m_ids.contains(n.m_node);
+    }
+
+    /**
+     * @brief Checks whether a node is an ancestor of another one, in O(1). A node is its own ancestor.
+     * @throws std::invalid_argument If any of the nodes is null or was not indexed.
+     */
+    [[nodiscard]] bool is_ancestor(node ancestor, node descendant) const
+    {
+        const index_type a = id_of(ancestor);
+        const index_type d = id_of(descendant);
+        return a <= d && d < a + m_subtree_size[a];
+    }
+
+    /**
+     * @brief Retrieves the lowest common ancestor of two nodes, in O(1).
+     * @throws std::invalid_argument If any of the nodes is null or was not indexed.
+     */
+    [[nodiscard]] node lca(node first, node second) const
+    {
+        index_type u = id_of(first);
+        index_type v = id_of(second);
+        if (u == v)
+            return m_nodes[u];
+        if (u > v)
+            std::swap(u, v);
+
+        // the shallowest node numbered in (u, v] is a child of the lowest common ancestor
+        const std::size_t length = v - u;
+        const int level = static_cast<int>(std::bit_width(length)) - 1;
+        const index_type child = level == 0 ? v
+                                            : shallower(m_sparse[level - 1][u + 1],
+                                                        m_sparse[level - 1][v + 1 - (std::size_t{1} << level)]);
+        return m_nodes[m_parent[child]];
+    }
+
+    /**
+     * @brief Returns the depth of the given node as it was when the index was built, in O(1).
+     * @throws std::invalid_argument If the node is null or was not indexed.
+     */
+    [[nodiscard]] std::size_t depth(node n) const
+    {
+        return m_depth[id_of(n)];
+    }
+
+private:
+    index_type shallower(index_type lhs, index_type rhs) const noexcept
+    {
+        return m_depth[rhs] < m_depth[lhs] ? rhs : lhs;
+    }
+
+    index_type id_of(node n) const
+    {
+        if (n.is_null())
+            throw std::invalid_argument("Cannot query a null node");
+
+        auto it = m_ids.find(n.m_node);
+        if (it == m_ids.end())
+            throw std::invalid_argument("Node is not part of the index");
+        return it->second;
+    }
+};
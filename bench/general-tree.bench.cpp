@@ -0,0 +1,388 @@
+// Measures the hot paths of general_tree on trees of several shapes and sizes.
+//
+// Usage: general_tree_bench [--sizes 1000,100000,1000000] [--shapes balanced,chain,fan,random] [--min-time 0.2]
+//
+// Every measurement is printed as one JSON object per line with the fields shape, nodes, operation, ops, ns_per_op,
+// nodes_per_s and peak_rss_kb. An operation is repeated until it has run for at least --min-time seconds, and the
+// setup of every repetition, such as copying the tree to be cleared, is left out of the time. Peak RSS is the high
+// water mark of the whole process so far, so it is meaningful for the largest tree measured up to that line.
+
+#include "compact-tree.h"
+#include "general-tree.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    using tree = general_tree<int>;
+    using clock_type = std::chrono::steady_clock;
+
+    constexpr std::size_t balanced_fan_out = 4;
+
+    // keeps results alive so that the measured work is not optimized away
+    volatile std::size_t sink;
+
+    struct options
+    {
+        std::vector<std::size_t> sizes{1000, 100000, 1000000};
+        std::vector<std::string> shapes{"balanced", "chain", "fan", "random"};
+        double min_time = 0.2;
+    };
+
+    struct sample
+    {
+        std::size_t ops = 0;
+        std::size_t nodes = 0;
+        double seconds = 0;
+    };
+
+    std::size_t peak_rss_kb()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0;
+        return counters.PeakWorkingSetSize / 1024;
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#ifdef __APPLE__
+        return static_cast<std::size_t>(usage.ru_maxrss) / 1024;
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#endif
+#endif
+    }
+
+    // - setup() builds the untimed state of one repetition, run(state) does the work and returns how many operations
+    //   and nodes it covered
+    template <typename Setup, typename Run>
+    sample measure(double min_time, Setup setup, Run run)
+    {
+        sample total;
+        do
+        {
+            auto state = setup();
+            const auto start = clock_type::now();
+            const auto [ops, nodes] = run(state);
+            total.seconds += std::chrono::duration<double>(clock_type::now() - start).count();
+            total.ops += ops;
+            total.nodes += nodes;
+        } while (total.seconds < min_time);
+        return total;
+    }
+
+    void report(const std::string& shape, std::size_t size, const char* operation, const sample& s)
+    {
+        std::printf("{\"shape\": \"%s\", \"nodes\": %zu, \"operation\": \"%s\", \"ops\": %zu, \"ns_per_op\": %.3f, "
+                    "\"nodes_per_s\": %.0f, \"peak_rss_kb\": %zu}\n",
+                    shape.c_str(), size, operation, s.ops, s.seconds * 1e9 / static_cast<double>(s.ops),
+                    static_cast<double>(s.nodes) / s.seconds, peak_rss_kb());
+        std::fflush(stdout);
+    }
+
+    // - parents are only needed by the random shape, and are drawn before the build is timed
+    std::vector<std::uint32_t> random_parents(std::size_t size)
+    {
+        std::mt19937 rng(42);
+        std::vector<std::uint32_t> parents(size);
+        for (std::size_t i = 1; i < size; i++)
+            parents[i] = static_cast<std::uint32_t>(rng() % i);
+        return parents;
+    }
+
+    // Builds the shape through emplace_left_child / emplace_right_sibling only. handles must have room for size nodes
+    // and parents must come from random_parents() for the random shape
+    tree build(const std::string& shape, std::size_t size, std::vector<tree::node>& handles,
+               const std::vector<std::uint32_t>& parents)
+    {
+        tree gt(0);
+        handles.clear();
+        tree::node last = gt.root();
+
+        if (shape == "balanced")
+        {
+            // breadth-first numbering, the children of node p are p * fan_out + 1 ... p * fan_out + fan_out
+            handles.push_back(last);
+            for (std::size_t i = 1; i < size; i++)
+            {
+                if ((i - 1) % balanced_fan_out == 0)
+                    last = gt.emplace_left_child(handles[(i - 1) / balanced_fan_out], static_cast<int>(i));
+                else
+                    last = gt.emplace_right_sibling(last, static_cast<int>(i));
+                handles.push_back(last);
+            }
+        }
+        else if (shape == "chain")
+        {
+            for (std::size_t i = 1; i < size; i++)
+                last = gt.emplace_left_child(last, static_cast<int>(i));
+        }
+        else if (shape == "fan")
+        {
+            if (size > 1)
+                last = gt.emplace_left_child(last, 1);
+            for (std::size_t i = 2; i < size; i++)
+                last = gt.emplace_right_sibling(last, static_cast<int>(i));
+        }
+        else if (shape == "random")
+        {
+            handles.push_back(last);
+            for (std::size_t i = 1; i < size; i++)
+                handles.push_back(gt.emplace_left_child(handles[parents[i]], static_cast<int>(i)));
+        }
+        else
+            throw std::invalid_argument("Unknown shape " + shape);
+
+        return gt;
+    }
+
+    void run_shape(const std::string& shape, std::size_t size, double min_time)
+    {
+        std::vector<tree::node> handles;
+        handles.reserve(shape == "balanced" || shape == "random" ? size : 0);
+        const auto parents = shape == "random" ? random_parents(size) : std::vector<std::uint32_t>();
+
+        report(shape, size, "build", measure(min_time, [] { return std::optional<tree>(); },
+                                             [&](std::optional<tree>& gt) {
+                                                 gt.emplace(build(shape, size, handles, parents));
+                                                 return std::pair(size, size);
+                                             }));
+
+        const tree original = build(shape, size, handles, parents);
+        handles.clear();
+
+        report(shape, size, "deep_copy", measure(min_time, [] { return std::optional<tree>(); },
+                                                 [&](std::optional<tree>& copy) {
+                                                     copy.emplace(original);
+                                                     return std::pair(std::size_t(1), size);
+                                                 }));
+
+        {
+            const tree copy = original;
+            report(shape, size, "operator==", measure(min_time, [] { return 0; }, [&](int) {
+                       sink = original == copy;
+                       return std::pair(std::size_t(1), size);
+                   }));
+        }
+
+        report(shape, size, "descendants_count", measure(min_time, [] { return 0; }, [&](int) {
+                   sink = original.root().descendants_count();
+                   return std::pair(std::size_t(1), size);
+               }));
+
+        // the visitors against the iterators and a loop written by hand over the links of the nodes
+        const auto summed = [&](auto sum) {
+            return measure(min_time, [] { return 0; }, [&](int) {
+                sink = sum();
+                return std::pair(std::size_t(1), size);
+            });
+        };
+
+        report(shape, size, "preorder_iterator", summed([&] {
+                   std::size_t total = 0;
+                   for (auto it = original.preorder_begin(); it != original.preorder_end(); ++it)
+                       total += static_cast<std::size_t>(*it);
+                   return total;
+               }));
+
+        report(shape, size, "handwritten_preorder", summed([&] {
+                   std::size_t total = 0;
+                   const tree::node root = original.root();
+                   tree::node current = root;
+                   while (true)
+                   {
+                       total += static_cast<std::size_t>(current.data());
+                       if (!current.is_leaf())
+                       {
+                           current = current.left_child();
+                           continue;
+                       }
+                       while (current != root && !current.has_right_sibling())
+                           current = current.parent();
+                       if (current == root)
+                           return total;
+                       current = current.right_sibling();
+                   }
+               }));
+
+        report(shape, size, "visit_preorder", summed([&] {
+                   std::size_t total = 0;
+                   original.visit<visit_order::preorder>(
+                       original.root(), [&](tree::node n) { total += static_cast<std::size_t>(n.data()); });
+                   return total;
+               }));
+
+        report(shape, size, "visit_postorder", summed([&] {
+                   std::size_t total = 0;
+                   original.visit<visit_order::postorder>(
+                       original.root(), [&](tree::node n) { total += static_cast<std::size_t>(n.data()); });
+                   return total;
+               }));
+
+        report(shape, size, "bfs_iterator", summed([&] {
+                   std::size_t total = 0;
+                   for (auto it = original.bfs_begin(); it != original.bfs_end(); ++it)
+                       total += static_cast<std::size_t>(*it);
+                   return total;
+               }));
+
+        report(shape, size, "visit_level_order", summed([&] {
+                   std::size_t total = 0;
+                   original.visit<visit_order::level_order>(
+                       original.root(), [&](tree::node n) { total += static_cast<std::size_t>(n.data()); });
+                   return total;
+               }));
+
+        {
+            // a whole traversal of the compact form, through its iterator and through node handles
+            const auto compact = original.compact_shared();
+
+            report(shape, size, "compact_preorder_iterator", summed([&] {
+                       std::size_t total = 0;
+                       for (auto it = compact.preorder_begin(); it != compact.preorder_end(); ++it)
+                           total += static_cast<std::size_t>(*it);
+                       return total;
+                   }));
+
+            report(shape, size, "compact_handles_preorder", summed([&] {
+                       std::size_t total = 0;
+                       compact_tree<int>::node current = compact.root();
+                       while (true)
+                       {
+                           total += static_cast<std::size_t>(current.data());
+                           if (!current.is_leaf())
+                           {
+                               current = current.left_child();
+                               continue;
+                           }
+                           while (!current.is_root() && !current.has_right_sibling())
+                               current = current.parent();
+                           if (current.is_root())
+                               return total;
+                           current = current.right_sibling();
+                       }
+                   }));
+        }
+
+        {
+            // random children of random inner nodes; a query may walk the siblings, so it is time-boxed instead of
+            // covering every node
+            std::vector<std::pair<tree::node, std::size_t>> inner;
+            for (auto it = original.preorder_begin(); it != original.preorder_end(); ++it)
+            {
+                const auto n = it.get_node();
+                if (!n.is_leaf())
+                    inner.emplace_back(n, n.children_count());
+            }
+
+            std::mt19937 rng(7);
+            std::vector<std::pair<tree::node, std::size_t>> queries(1024);
+            for (auto& query : queries)
+            {
+                const auto& [n, count] = inner.empty() ? std::pair(original.root(), std::size_t(1))
+                                                       : inner[rng() % inner.size()];
+                query = {n, rng() % count};
+            }
+
+            report(shape, size, "child", measure(min_time, [] { return 0; }, [&](int) {
+                       std::size_t ops = 0;
+                       const auto start = clock_type::now();
+                       for (const auto& [n, index] : queries)
+                       {
+                           sink = n.child(index).is_null();
+                           ++ops;
+                           if ((ops & 15) == 0 &&
+                               std::chrono::duration<double>(clock_type::now() - start).count() > min_time)
+                               break;
+                       }
+                       return std::pair(ops, ops);
+                   }));
+        }
+
+        report(shape, size, "delete_left_child", measure(min_time, [&] { return original; }, [&](tree& gt) {
+                   std::size_t ops = 0;
+                   for (; !gt.root().is_leaf(); ++ops)
+                       gt.delete_left_child(gt.root());
+                   return std::pair(ops, size - 1);
+               }));
+
+        report(shape, size, "clear", measure(min_time, [&] { return original; }, [&](tree& gt) {
+                   gt.clear();
+                   return std::pair(std::size_t(1), size);
+               }));
+    }
+
+    template <typename Parse>
+    auto split(const std::string& list, Parse parse)
+    {
+        std::vector<decltype(parse(std::string()))> values;
+        std::stringstream stream(list);
+        for (std::string item; std::getline(stream, item, ',');)
+            values.push_back(parse(item));
+        return values;
+    }
+
+    options parse_options(int argc, char** argv)
+    {
+        options result;
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 == argc)
+                throw std::invalid_argument("Missing value for " + arg);
+
+            const std::string value = argv[++i];
+            if (arg == "--sizes")
+                result.sizes = split(value, [](const std::string& item) {
+                    return static_cast<std::size_t>(std::stoull(item));
+                });
+            else if (arg == "--shapes")
+                result.shapes = split(value, [](const std::string& item) { return item; });
+            else if (arg == "--min-time")
+                result.min_time = std::stod(value);
+            else
+                throw std::invalid_argument("Unknown option " + arg);
+        }
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const options opts = parse_options(argc, argv);
+        for (std::size_t size : opts.sizes)
+        {
+            if (size == 0)
+                throw std::invalid_argument("Sizes must be positive");
+            for (const std::string& shape : opts.shapes)
+                run_shape(shape, size, opts.min_time);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "general_tree_bench: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,515 @@
+#pragma once
+
+#include "general-tree.h"
+#include "shared-release.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Read-only tree storing every distinct subtree once, as a directed acyclic graph.
+ *
+ * Two subtrees are identical when their values compare equal and their children are identical, in order. Building
+ * the tree hashes every subtree bottom-up from its value and the identifiers of its children, so each distinct
+ * subtree gets one identifier, one copy of its value and one list of children identifiers. Trees made of many
+ * repeated subtrees shrink to the size of their distinct parts.
+ *
+ * Since a shared subtree has many parents, node handles remember the path they were reached through, which gives
+ * them parent() and right_sibling() as in general_tree. That path is allocated at every step down, so handles are
+ * meant for random access; whole traversals go through preorder_begin(), which keeps the path on its own stack.
+ */
+template <typename T>
+class compact_tree
+{
+public:
+    using index_type = std::uint32_t;
+
+    static constexpr index_type null_index = std::numeric_limits<index_type>::max();
+
+private:
+    // per distinct subtree: its value, the size of its expansion and the range of its children in m_children
+    std::vector<T> m_values;
+    std::vector<std::size_t> m_sizes;
+    std::vector<index_type> m_offsets;
+    std::vector<index_type> m_children;
+    index_type m_root = null_index;
+
+    // occurrence of a distinct subtree as an ancestor of a node handle, shared by the handles below it
+    struct frame
+    {
+        index_type m_subtree;
+        index_type m_slot;
+        std::size_t m_depth;
+        std::shared_ptr<const frame> m_up;
+
+        frame(index_type subtree, index_type slot, std::size_t depth, std::shared_ptr<const frame> up) noexcept
+            : m_subtree(subtree), m_slot(slot), m_depth(depth), m_up(std::move(up))
+        {
+        }
+
+        frame(const frame&) = delete;
+        frame& operator=(const frame&) = delete;
+
+        ~frame()
+        {
+            // paths may be as long as the tree is deep
+            release_shared(std::move(m_up));
+        }
+    };
+
+    using frame_ptr = std::shared_ptr<const frame>;
+
+public:
+    /**
+     * @brief Public node interface
+     */
+    class node
+    {
+    private:
+        const compact_tree* m_tree = nullptr;
+        index_type m_subtree = null_index;
+        index_type m_slot = null_index;
+        frame_ptr m_parent;
+        friend class compact_tree;
+
+        node(const compact_tree* tree, index_type subtree, index_type slot, frame_ptr parent) noexcept
+            : m_tree(tree), m_subtree(subtree), m_slot(slot), m_parent(std::move(parent))
+        {
+        }
+
+        index_type first_slot() const noexcept
+        {
+            return m_tree->m_offsets[m_subtree];
+        }
+
+        index_type end_slot() const noexcept
+        {
+            return m_tree->m_offsets[m_subtree + 1];
+        }
+
+    public:
+        node() noexcept = default;
+
+        /**
+         * @brief Two handles are equal when they refer to the same occurrence of a subtree.
+         */
+        bool operator==(const node& other) const noexcept
+        {
+            if (m_tree != other.m_tree || m_subtree != other.m_subtree || m_slot != other.m_slot)
+                return false;
+
+            // the same slot of the same distinct subtree occurs under every copy of the parent
+            const frame* lhs = m_parent.get();
+            const frame* rhs = other.m_parent.get();
+            while (lhs != rhs)
+            {
+                if (lhs == nullptr || rhs == nullptr || lhs->m_slot != rhs->m_slot)
+                    return false;
+                lhs = lhs->m_up.get();
+                rhs = rhs->m_up.get();
+            }
+            return true;
+        }
+
+        /**
+         * @brief Identifier of the distinct subtree rooted at the node, shared by all of its copies.
+         */
+        [[nodiscard]] index_type subtree_id() const noexcept
+        {
+            return m_subtree;
+        }
+
+        /**
+         * @brief Retrieves the left child of the current node.
+         * @return The left child node, or a null node if the current node has no left child.
+         */
+        [[nodiscard]] node left_child() const
+        {
+            if (is_leaf())
+                return node();
+
+            const index_type slot = first_slot();
+            auto parent = std::make_shared<const frame>(m_subtree, m_slot, depth(), m_parent);
+            return node(m_tree, m_tree->m_children[slot], slot, std::move(parent));
+        }
+
+        /**
+         * @brief Retrieves the parent of the current node.
+         * @return The parent node, or a null node if the current node has no parent.
+         */
+        [[nodiscard]] node parent() const noexcept
+        {
+            if (m_parent == nullptr)
+                return node();
+            return node(m_tree, m_parent->m_subtree, m_parent->m_slot, m_parent->m_up);
+        }
+
+        /**
+         * @brief Retrieves the right sibling of the current node.
+         * @return The right sibling node, or a null node if the current node has no right sibling.
+         */
+        [[nodiscard]] node right_sibling() const noexcept
+        {
+            if (!has_right_sibling())
+                return node();
+            return node(m_tree, m_tree->m_children[m_slot + 1], m_slot + 1, m_parent);
+        }
+
+        /**
+         * @brief Accesses the data stored in the given node.
+         * @return const T& Reference to the data stored in the node.
+         * @throws std::invalid_argument If the given node is null.
+         */
+        [[nodiscard]] const T& data() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get data from null node");
+            return m_tree->m_values[m_subtree];
+        }
+
+        /**
+         * @brief Checks if the node is the root of the tree.
+         * @return true if the node is the root, false otherwise.
+         */
+        bool is_root() const noexcept
+        {
+            return m_parent == nullptr;
+        }
+
+        /**
+         * @brief Checks if the node is a leaf in the tree.
+         * @return true if the node is a leaf, false otherwise.
+         */
+        bool is_leaf() const noexcept
+        {
+            return first_slot() == end_slot();
+        }
+
+        /**
+         * @brief Checks if the node has a right sibling.
+         * @return true if the node has a right sibling, false otherwise.
+         */
+        bool has_right_sibling() const noexcept
+        {
+            return m_parent != nullptr && m_slot + 1 < m_tree->m_offsets[m_parent->m_subtree + 1];
+        }
+
+        /**
+         * @brief Checks if the node has a left child.
+         * @return true if the node has a left child, false otherwise.
+         */
+        bool has_left_child() const noexcept
+        {
+            return !is_leaf();
+        }
+
+        /**
+         * @brief Checks if the node is null.
+         * @return true if the node is null, false otherwise.
+         */
+        bool is_null() const noexcept
+        {
+            return m_tree == nullptr;
+        }
+
+        /**
+         * @brief Retrieves the child node at the specified index, in O(1).
+         * @param index The zero-based index of the child to retrieve.
+         * @return The child node at the specified index, or a null node if the index is out of range.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] node child(std::size_t index) const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get child of null node");
+            if (index >= children_count())
+                return node();
+
+            const index_type slot = first_slot() + static_cast<index_type>(index);
+            auto parent = std::make_shared<const frame>(m_subtree, m_slot, depth(), m_parent);
+            return node(m_tree, m_tree->m_children[slot], slot, std::move(parent));
+        }
+
+        /**
+         * @brief Counts the number of children of the current node, in O(1).
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t children_count() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot count children of null node");
+            return end_slot() - first_slot();
+        }
+
+        /**
+         * @brief Returns the depth of the current node in the tree, in O(1).
+         * @throws std::invalid_argument if the node is null.
+         */
+        [[nodiscard]] std::size_t depth() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get depth of null node");
+            return m_parent == nullptr ? 0 : m_parent->m_depth + 1;
+        }
+
+        /**
+         * @brief Returns the total number of descendants of the current node, in O(1).
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t descendants_count() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get descendants of null node");
+            return m_tree->m_sizes[m_subtree] - 1;
+        }
+    };
+
+    /**
+     * @brief Forward iterator over the values of the expanded tree in pre-order.
+     *
+     * The path from the root to the current node is kept as a stack of slots, so moving to the next node allocates
+     * nothing once the stack has grown to the depth of the tree.
+     */
+    class preorder_iterator
+    {
+    private:
+        // - a node on the path below the root, as its slot in m_children and the end of the slots of its siblings
+        struct level
+        {
+            index_type m_slot;
+            index_type m_end;
+
+            bool operator==(const level&) const = default;
+        };
+
+        const compact_tree* m_tree = nullptr;
+        index_type m_current = null_index;
+        std::vector<level> m_path;
+        friend class compact_tree;
+
+        preorder_iterator(const compact_tree* tree, index_type root) : m_tree(tree), m_current(root) {}
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        preorder_iterator() noexcept = default;
+
+        reference operator*() const noexcept
+        {
+            return m_tree->m_values[m_current];
+        }
+
+        pointer operator->() const noexcept
+        {
+            return &m_tree->m_values[m_current];
+        }
+
+        preorder_iterator& operator++()
+        {
+            const index_type first = m_tree->m_offsets[m_current];
+            const index_type end = m_tree->m_offsets[m_current + 1];
+            if (first != end)
+            {
+                m_path.push_back({first, end});
+                m_current = m_tree->m_children[first];
+                return *this;
+            }
+
+            while (!m_path.empty())
+            {
+                level& top = m_path.back();
+                if (++top.m_slot != top.m_end)
+                {
+                    m_current = m_tree->m_children[top.m_slot];
+                    return *this;
+                }
+                m_path.pop_back();
+            }
+
+            m_current = null_index;
+            return *this;
+        }
+
+        preorder_iterator operator++(int)
+        {
+            preorder_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const preorder_iterator& other) const noexcept
+        {
+            return m_current == other.m_current && m_path == other.m_path;
+        }
+
+        /**
+         * @brief Returns the depth of the current node, in O(1).
+         */
+        [[nodiscard]] std::size_t depth() const noexcept
+        {
+            return m_path.size();
+        }
+
+        /**
+         * @brief Identifier of the distinct subtree rooted at the current node.
+         */
+        [[nodiscard]] index_type subtree_id() const noexcept
+        {
+            return m_current;
+        }
+
+        /**
+         * @brief Returns a handle to the current node, building its path in O(depth).
+         */
+        [[nodiscard]] node get_node() const
+        {
+            if (m_path.empty())
+                return node(m_tree, m_current, null_index, nullptr);
+
+            auto parent = std::make_shared<const frame>(m_tree->m_root, null_index, 0, nullptr);
+            for (std::size_t i = 0; i + 1 < m_path.size(); i++)
+            {
+                const index_type slot = m_path[i].m_slot;
+                parent = std::make_shared<const frame>(m_tree->m_children[slot], slot, i + 1, std::move(parent));
+            }
+            return node(m_tree, m_current, m_path.back().m_slot, std::move(parent));
+        }
+    };
+
+    compact_tree() = default;
+
+    /**
+     * @brief Builds the compact form of the given tree. Requires std::hash<T> and T::operator==.
+     * @throws std::length_error If the tree has more nodes than 32-bit indices can address.
+     */
+    template <typename Allocator, tree_feature Features, typename Augmentation>
+    explicit compact_tree(const general_tree<T, Allocator, Features, Augmentation>& tree)
+    {
+        // Post-order walk: the identifiers of the children of a node are the last ones pushed when it is reached
+
+        std::unordered_multimap<std::size_t, index_type> distinct;
+        std::vector<index_type> pending;
+        m_offsets.push_back(0);
+
+        for (auto it = tree.postorder_begin(); it != tree.postorder_end(); ++it)
+        {
+            auto n = it.get_node();
+            const std::size_t children = n.children_count();
+            const std::size_t first = pending.size() - children;
+
+            std::size_t hash = std::hash<T>{}(*it);
+            for (std::size_t i = first; i < pending.size(); i++)
+                hash ^= pending[i] + static_cast<std::size_t>(0x9e3779b97f4a7c15ull) + (hash << 6) + (hash >> 2);
+
+            index_type id = null_index;
+            auto [candidate, last] = distinct.equal_range(hash);
+            for (; candidate != last; ++candidate)
+            {
+                if (same_subtree(candidate->second, *it, pending.data() + first, children))
+                {
+                    id = candidate->second;
+                    break;
+                }
+            }
+
+            if (id == null_index)
+            {
+                id = add_subtree(*it, pending.data() + first, children);
+                distinct.emplace(hash, id);
+            }
+
+            pending.resize(first);
+            pending.push_back(id);
+        }
+
+        if (!pending.empty())
+            m_root = pending.back();
+    }
+
+    /**
+     * @brief Returns the root node of the tree.
+     */
+    [[nodiscard]] node root() const noexcept
+    {
+        return empty() ? node() : node(this, m_root, null_index, nullptr);
+    }
+
+    /**
+     * @brief Returns an iterator to the first node of the expanded tree in pre-order, the root.
+     */
+    [[nodiscard]] preorder_iterator preorder_begin() const
+    {
+        return empty() ? preorder_iterator() : preorder_iterator(this, m_root);
+    }
+
+    [[nodiscard]] preorder_iterator preorder_end() const noexcept
+    {
+        return preorder_iterator();
+    }
+
+    /**
+     * @brief Checks whether the tree is empty.
+     */
+    bool empty() const noexcept
+    {
+        return m_values.empty();
+    }
+
+    /**
+     * @brief Returns the number of nodes of the tree once expanded.
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return empty() ? 0 : m_sizes[m_root];
+    }
+
+    /**
+     * @brief Returns the number of distinct subtrees, which is the number of values actually stored.
+     */
+    [[nodiscard]] std::size_t distinct_count() const noexcept
+    {
+        return m_values.size();
+    }
+
+private:
+    bool same_subtree(index_type id, const T& value, const index_type* children, std::size_t count) const
+    {
+        if (m_offsets[id + 1] - m_offsets[id] != count || !(m_values[id] == value))
+            return false;
+        return std::equal(children, children + count, m_children.begin() + m_offsets[id]);
+    }
+
+    index_type add_subtree(const T& value, const index_type* children, std::size_t count)
+    {
+        if (m_values.size() >= null_index - 1 || m_children.size() + count >= null_index)
+            throw std::length_error("Tree too large to be compacted");
+
+        std::size_t size = 1;
+        for (std::size_t i = 0; i < count; i++)
+            size += m_sizes[children[i]];
+
+        m_values.push_back(value);
+        m_sizes.push_back(size);
+        m_children.insert(m_children.end(), children, children + count);
+        m_offsets.push_back(static_cast<index_type>(m_children.size()));
+        return static_cast<index_type>(m_values.size() - 1);
+    }
+};
+
+template <typename T, typename Allocator, tree_feature Features, typename Augmentation>
+compact_tree<T> general_tree<T, Allocator, Features, Augmentation>::compact_shared() const
+{
+    return compact_tree<T>(*this);
+}
@@ -0,0 +1,349 @@
+#pragma once
+
+#include "general-tree.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Immutable snapshot of a general_tree laid out in pre-order.
+ *
+ * Values are stored contiguously in pre-order, next to two arrays of 32-bit indices: the parent and the subtree size
+ * of every node. The first child of a node is the next slot and its right sibling is the slot right after its own
+ * subtree, so full traversals are sequential scans and every subtree is a contiguous slice of the value array.
+ */
+template <typename T>
+class frozen_tree
+{
+public:
+    using index_type = std::uint32_t;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    static constexpr index_type null_index = std::numeric_limits<index_type>::max();
+
+private:
+    std::vector<T> m_data;
+    std::vector<index_type> m_parent;
+    std::vector<index_type> m_subtree_size;
+
+public:
+    /**
+     * @brief Public node interface
+     */
+    class node
+    {
+    private:
+        const frozen_tree* m_tree;
+        index_type m_index;
+        friend class frozen_tree;
+
+        node(const frozen_tree* tree, index_type index) noexcept : m_tree(tree), m_index(index) {}
+
+        node make(index_type index) const noexcept
+        {
+            return node(index == null_index ? nullptr : m_tree, index);
+        }
+
+    public:
+        node() noexcept : m_tree(nullptr), m_index(null_index) {}
+
+        bool operator==(const node& other) const noexcept
+        {
+            return m_tree == other.m_tree && m_index == other.m_index;
+        }
+
+        /**
+         * @brief Position of the node in the pre-order layout, or null_index for a null node.
+         */
+        [[nodiscard]] index_type index() const noexcept
+        {
+            return m_index;
+        }
+
+        /**
+         * @brief Retrieves the left child of the current node.
+         * @return The left child node, or a null node if the current node has no left child.
+         */
+        [[nodiscard]] node left_child() const noexcept
+        {
+            return is_leaf() ? node() : make(m_index + 1);
+        }
+
+        /**
+         * @brief Retrieves the parent of the current node.
+         * @return The parent node, or a null node if the current node has no parent.
+         */
+        [[nodiscard]] node parent() const noexcept
+        {
+            return make(m_tree->m_parent[m_index]);
+        }
+
+        /**
+         * @brief Retrieves the right sibling of the current node.
+         * @return The right sibling node, or a null node if the current node has no right sibling.
+         */
+        [[nodiscard]] node right_sibling() const noexcept
+        {
+            return has_right_sibling() ? make(m_index + m_tree->m_subtree_size[m_index]) : node();
+        }
+
+        /**
+         * @brief Accesses the data stored in the given node.
+         * @return const T& Reference to the data stored in the node.
+         * @throws std::invalid_argument If the given node is null.
+         */
+        [[nodiscard]] const T& data() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get data from null node");
+            return m_tree->m_data[m_index];
+        }
+
+        /**
+         * @brief Checks if the node is the root of the tree.
+         * @return true if the node is the root, false otherwise.
+         */
+        bool is_root() const noexcept
+        {
+            return m_index == 0;
+        }
+
+        /**
+         * @brief Checks if the node is a leaf in the tree.
+         * @return true if the node is a leaf, false otherwise.
+         */
+        bool is_leaf() const noexcept
+        {
+            return m_tree->m_subtree_size[m_index] == 1;
+        }
+
+        /**
+         * @brief Checks if the node has a right sibling.
+         * @return true if the node has a right sibling, false otherwise.
+         */
+        bool has_right_sibling() const noexcept
+        {
+            const index_type parent = m_tree->m_parent[m_index];
+            return parent != null_index &&
+                   m_index + m_tree->m_subtree_size[m_index] < parent + m_tree->m_subtree_size[parent];
+        }
+
+        /**
+         * @brief Checks if the node has a left child.
+         * @return true if the node has a left child, false otherwise.
+         */
+        bool has_left_child() const noexcept
+        {
+            return !is_leaf();
+        }
+
+        /**
+         * @brief Checks if the node is null.
+         * @return true if the node is null, false otherwise.
+         */
+        bool is_null() const noexcept
+        {
+            return m_tree == nullptr;
+        }
+
+        /**
+         * @brief Retrieves the child node at the specified index.
+         * @param index The zero-based index of the child to retrieve.
+         * @return The child node at the specified index, or a null node if the index is out of range.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] node child(std::size_t index) const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get child of null node");
+
+            node child = left_child();
+            for (std::size_t i = 0; i < index && !child.is_null(); i++)
+                child = child.right_sibling();
+
+            return child;
+        }
+
+        /**
+         * @brief Counts the number of children of the current node.
+         * @return The total number of children of the current node.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t children_count() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot count children of null node");
+
+            std::size_t count = 0;
+            const index_type end = m_index + m_tree->m_subtree_size[m_index];
+            for (index_type child = m_index + 1; child < end; child += m_tree->m_subtree_size[child])
+                ++count;
+
+            return count;
+        }
+
+        /**
+         * @brief Computes the depth of the current node in the tree.
+         * @throws std::invalid_argument if the node is null.
+         * @return std::size_t The depth of the node.
+         */
+        [[nodiscard]] std::size_t depth() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get depth of null node");
+
+            std::size_t depth = 0;
+            for (index_type aux = m_tree->m_parent[m_index]; aux != null_index; aux = m_tree->m_parent[aux])
+                ++depth;
+
+            return depth;
+        }
+
+        /**
+         * @brief Returns the total number of descendants of the current node in O(1).
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t descendants_count() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get descendants of null node");
+            return m_tree->m_subtree_size[m_index] - 1;
+        }
+
+        /**
+         * @brief Returns the values of the current node and all of its descendants, in pre-order.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::span<const T> subtree() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot traverse subtree of null node");
+            return std::span<const T>(m_tree->m_data).subspan(m_index, m_tree->m_subtree_size[m_index]);
+        }
+    };
+
+    frozen_tree() = default;
+
+    /**
+     * @brief Takes a snapshot of the given tree.
+     * @throws std::length_error If the tree has more nodes than 32-bit indices can address.
+     */
+    template <typename Allocator, tree_feature Features, typename Augmentation>
+    explicit frozen_tree(const general_tree<T, Allocator, Features, Augmentation>& tree)
+    {
+        // Pre-order walk over the source tree
+        // The index of the current node is tracked alongside, so climbing back uses the parent array being built
+
+        auto source_root = tree.root();
+        if (source_root.is_null())
+            return;
+
+        auto current = source_root;
+        index_type current_index = 0;
+        append(current.data(), null_index);
+
+        while (true)
+        {
+            if (current.has_left_child())
+            {
+                current = current.left_child();
+                current_index = append(current.data(), current_index);
+                continue;
+            }
+
+            while (current != source_root && !current.has_right_sibling())
+            {
+                current = current.parent();
+                current_index = m_parent[current_index];
+            }
+
+            if (current == source_root)
+                break;
+
+            current = current.right_sibling();
+            current_index = append(current.data(), m_parent[current_index]);
+        }
+
+        // children come after their parent, a reverse scan accumulates every subtree
+        m_subtree_size.assign(m_data.size(), 1);
+        for (std::size_t i = m_data.size() - 1; i > 0; i--)
+            m_subtree_size[m_parent[i]] += m_subtree_size[i];
+    }
+
+    /**
+     * @brief Returns the root node of the tree.
+     */
+    [[nodiscard]] node root() const noexcept
+    {
+        return empty() ? node() : node(this, 0);
+    }
+
+    /**
+     * @brief Checks whether the tree is empty.
+     */
+    bool empty() const noexcept
+    {
+        return m_data.empty();
+    }
+
+    /**
+     * @brief Returns the number of nodes of the tree.
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_data.size();
+    }
+
+    /**
+     * @brief Returns the node stored at the given pre-order position.
+     * @throws std::out_of_range If the index is not smaller than size().
+     */
+    [[nodiscard]] node at(std::size_t index) const
+    {
+        if (index >= m_data.size())
+            throw std::out_of_range("Node index out of range");
+        return node(this, static_cast<index_type>(index));
+    }
+
+    /**
+     * @brief Returns an iterator to the first value of the tree in pre-order (the root).
+     */
+    [[nodiscard]] const_iterator begin() const noexcept
+    {
+        return m_data.begin();
+    }
+
+    /**
+     * @brief Returns the past-the-end pre-order iterator.
+     */
+    [[nodiscard]] const_iterator end() const noexcept
+    {
+        return m_data.end();
+    }
+
+    bool operator==(const frozen_tree& other) const
+    {
+        // the pre-order sequence of subtree sizes determines the shape
+        return m_subtree_size == other.m_subtree_size && m_data == other.m_data;
+    }
+
+private:
+    index_type append(const T& value, index_type parent)
+    {
+        if (m_data.size() >= null_index)
+            throw std::length_error("Tree too large to be frozen");
+
+        m_data.push_back(value);
+        m_parent.push_back(parent);
+        return static_cast<index_type>(m_data.size() - 1);
+    }
+};
+
+template <typename T, typename Allocator, tree_feature Features, typename Augmentation>
+frozen_tree<T> general_tree<T, Allocator, Features, Augmentation>::freeze() const
+{
+    return frozen_tree<T>(*this);
+}
@@ -1,116 +1,1712 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <queue>
+#include <ranges>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+/**
+ * @brief Optional bookkeeping that a general_tree maintains in every node.
+ *
+ * Features are combined with operator| and selected through the third template parameter of general_tree. Each one
+ * trades some memory per node and some work on every structural change for faster queries.
+ */
+enum class tree_feature : unsigned
+{
+    none = 0,
+
+    // children_count() and child(index) in O(1), amortized O(1) insertions and deletions of first and last children,
+    // O(children) for the others
+    indexed_children = 1u << 0,
+
+    // left_sibling() and the unlinking of any node in O(1)
+    left_sibling_links = 1u << 1,
+
+    // descendants_count() in O(1), descendant_at(position) in O(depth * children), O(depth) insertions and deletions
+    subtree_sizes = 1u << 2,
+
+    // depth() in O(1), splicing a tree in becomes O(size of the spliced tree)
+    cached_depth = 1u << 3,
+
+    // subtree_hash() in O(1) and early rejection in operator==, insertions, deletions and update_data() become
+    // O(depth), plus O(right siblings) in the middle of the children; values can only be modified through update_data()
+    structural_hash = 1u << 4,
+
+    // memory_stats() in O(1), counted at every node and page allocation of the tree
+    allocation_stats = 1u << 5,
+};
+
+constexpr tree_feature operator|(tree_feature lhs, tree_feature rhs) noexcept
+{
+    return static_cast<tree_feature>(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
+}
+
+constexpr bool has_feature(tree_feature features, tree_feature feature) noexcept
+{
+    return (static_cast<unsigned>(features) & static_cast<unsigned>(feature)) != 0;
+}
+
+/**
+ * @brief Order in which general_tree::visit() reaches the nodes of a subtree.
+ */
+enum class visit_order
+{
+    preorder,
+    postorder,
+    level_order,
+};
+
+/**
+ * @brief Memory held by the node storage of a general_tree, as returned by general_tree::memory_stats().
+ *
+ * Node storage is obtained in pages, so the bytes reserved exceed the bytes used by live nodes. The counters follow
+ * the pages when storage changes hands, such as when a tree is moved or spliced into another one.
+ */
+struct tree_memory_stats
+{
+    std::size_t live_nodes = 0;
+    std::size_t peak_live_nodes = 0;
+    std::size_t bytes_used = 0;
+    std::size_t peak_bytes_used = 0;
+    std::size_t bytes_reserved = 0;
+    std::size_t peak_bytes_reserved = 0;
+    // pages obtained from and returned to the allocator
+    std::size_t allocations = 0;
+    std::size_t frees = 0;
+    std::size_t nodes_created = 0;
+    std::size_t nodes_destroyed = 0;
+};
+
+/**
+ * @brief Augmentation policy of a general_tree keeping no aggregate.
+ *
+ * An augmentation policy keeps an aggregate of every subtree up to date while the tree changes. It provides:
+ * - value_type, the type of the aggregate
+ * - static value_type from_value(const T&), the aggregate of a node on its own
+ * - static value_type combine(const value_type&, const value_type&), associative, called with the aggregate folded so
+ *   far and the aggregate of the next child, in sibling order
+ * - optionally static constexpr bool lazy = true, which defers the updates until an aggregate is read
+ *
+ * Neither from_value nor combine may throw.
+ */
+struct no_augmentation
+{
+    struct value_type
+    {
+    };
+
+    template <typename T>
+    static value_type from_value(const T&) noexcept
+    {
+        return {};
+    }
+
+    static value_type combine(value_type, value_type) noexcept
+    {
+        return {};
+    }
+};
+
+template <typename T>
+class frozen_tree;
+
+template <typename Tree>
+class ancestry_index;
 
 template <typename T>
+class compact_tree;
+
+template <typename T, typename Allocator = std::allocator<T>, tree_feature Features = tree_feature::none,
+          typename Augmentation = no_augmentation>
 class general_tree
 {
 public:
     class node;
+    class sibling_range;
+    using value_type = T;
+    using allocator_type = Allocator;
+    using augmentation_type = Augmentation;
+
+    static constexpr tree_feature features = Features;
+
+private:
+    static constexpr bool indexed_children = has_feature(Features, tree_feature::indexed_children);
+    static constexpr bool left_sibling_links = has_feature(Features, tree_feature::left_sibling_links);
+    static constexpr bool subtree_sizes = has_feature(Features, tree_feature::subtree_sizes);
+    static constexpr bool cached_depth = has_feature(Features, tree_feature::cached_depth);
+    static constexpr bool structural_hash = has_feature(Features, tree_feature::structural_hash);
+    static constexpr bool allocation_stats = has_feature(Features, tree_feature::allocation_stats);
+    static constexpr bool augmented = !std::is_same_v<Augmentation, no_augmentation>;
+    static constexpr bool lazy_augmentation = requires { requires Augmentation::lazy; };
+
+    // values feeding bookkeeping cannot be modified behind the tree's back
+    static constexpr bool mutable_values = !structural_hash && !augmented;
+
+    struct private_node;
+
+    struct no_field
+    {
+    };
+
+    // - the children are the last m_count entries of m_children, the entries before them are free room for children
+    //   linked in front; the room doubles when it runs out and is given back once it outgrows the children
+    // - reserve() is the only member that allocates, the insertions it makes room for cannot throw
+    struct children_index
+    {
+        std::size_t m_count = 0;
+        std::vector<private_node*> m_children;
+
+        [[nodiscard]] std::size_t room() const noexcept
+        {
+            return m_children.size() - m_count;
+        }
+
+        void reserve(std::size_t count, bool front)
+        {
+            if (front && m_count != 0)
+            {
+                if (room() >= count)
+                    return;
+
+                const std::size_t added = std::max(count, m_count);
+                std::vector<private_node*> grown(added + m_count, nullptr);
+                std::copy(m_children.end() - static_cast<std::ptrdiff_t>(m_count), m_children.end(),
+                          grown.begin() + static_cast<std::ptrdiff_t>(added));
+                m_children.swap(grown);
+            }
+            else if (m_children.capacity() - m_children.size() < count)
+                m_children.reserve(std::max(m_children.size() + count, 2 * m_children.size()));
+        }
+
+        // - first and its count - 1 right siblings, before or after the children
+        void insert(private_node* first, std::size_t count, bool front) noexcept
+        {
+            if (front && m_count != 0)
+            {
+                for (std::size_t i = room() - count; count > 0; --count, first = first->m_right_sibling, ++m_count)
+                    m_children[i++] = first;
+                return;
+            }
+
+            for (; count > 0; --count, first = first->m_right_sibling, ++m_count)
+                m_children.push_back(first);
+        }
+
+        void insert_after(private_node* sibling, private_node* child) noexcept
+        {
+            if (m_children.back() == sibling)
+                insert(child, 1, false);
+            else
+            {
+                const auto position = std::find(m_children.begin() + static_cast<std::ptrdiff_t>(room()),
+                                                m_children.end(), sibling);
+                m_children.insert(position + 1, child);
+                ++m_count;
+            }
+        }
+
+        void erase(private_node* child) noexcept
+        {
+            const auto first = m_children.begin() + static_cast<std::ptrdiff_t>(room());
+            if (m_children.back() == child)
+                m_children.pop_back();
+            else if (*first != child)
+                m_children.erase(std::find(first, m_children.end(), child));
+
+            if (--m_count == 0)
+                m_children.clear();
+            else if (room() > m_count)
+                m_children.erase(m_children.begin(), m_children.begin() + static_cast<std::ptrdiff_t>(room()));
+        }
+
+        [[nodiscard]] private_node* operator[](std::size_t index) const noexcept
+        {
+            return m_children[room() + index];
+        }
+    };
+
+    // - m_children is the sum of the hash of every child times its weight, the weights of consecutive children are
+    //   consecutive powers of hash_base and m_next_weight is the one after the last child
+    struct hash_field
+    {
+        std::size_t m_value;
+        std::size_t m_children;
+        std::size_t m_weight;
+        std::size_t m_next_weight;
+    };
+
+    // - a dirty aggregate is stale, and so are the aggregates of all its ancestors
+    struct aggregate_field
+    {
+        typename Augmentation::value_type m_value;
+        [[no_unique_address]] std::conditional_t<lazy_augmentation, bool, no_field> m_dirty;
+    };
+
+    struct private_node
+    {
+        T m_data;
+        private_node* m_right_sibling;
+        private_node* m_left_child;
+        private_node* m_last_child;
+        private_node* m_parent;
+        [[no_unique_address]] std::conditional_t<indexed_children, children_index, no_field> m_children_index;
+        [[no_unique_address]] std::conditional_t<left_sibling_links, private_node*, no_field> m_left_sibling;
+        [[no_unique_address]] std::conditional_t<subtree_sizes, std::size_t, no_field> m_subtree_size;
+        [[no_unique_address]] std::conditional_t<cached_depth, std::size_t, no_field> m_depth;
+        [[no_unique_address]] std::conditional_t<structural_hash, hash_field, no_field> m_hash;
+        [[no_unique_address]] std::conditional_t<augmented, aggregate_field, no_field> m_aggregate;
+
+        template <typename... Args>
+        private_node(Args&&... args)
+            : m_data(std::forward<Args>(args)...), m_right_sibling(nullptr), m_left_child(nullptr),
+              m_last_child(nullptr), m_parent(nullptr)
+        {
+            if constexpr (left_sibling_links)
+                m_left_sibling = nullptr;
+            if constexpr (subtree_sizes)
+                m_subtree_size = 1;
+            if constexpr (cached_depth)
+                m_depth = 0;
+            if constexpr (structural_hash)
+                m_hash = {hash_combine(std::hash<T>{}(m_data), 0), 0, 1, 1};
+            if constexpr (augmented)
+                m_aggregate.m_value = Augmentation::from_value(m_data);
+            if constexpr (lazy_augmentation)
+                m_aggregate.m_dirty = false;
+        }
+    };
+
+    /**
+     * @brief Arena that hands out private_node storage.
+     *
+     * Slots are carved from pages obtained through the tree allocator. Page sizes grow geometrically, so small trees
+     * stay small and large trees pay for one allocation per page instead of one per node. Destroyed nodes are kept in
+     * a free list and reused by the next allocation; pages are only returned by release().
+     */
+    class node_pool
+    {
+    private:
+        union slot
+        {
+            slot* m_next_free;
+            alignas(private_node) unsigned char m_storage[sizeof(private_node)];
+        };
+
+        struct page
+        {
+            slot* m_slots;
+            std::size_t m_size;
+        };
+
+        // - kept with tree_feature::allocation_stats, sizes are counted in slots
+        struct counters
+        {
+            std::size_t m_live = 0;
+            std::size_t m_peak_live = 0;
+            std::size_t m_reserved = 0;
+            std::size_t m_peak_reserved = 0;
+            std::size_t m_allocations = 0;
+            std::size_t m_frees = 0;
+            std::size_t m_created = 0;
+            std::size_t m_destroyed = 0;
+
+            void absorb(const counters& other) noexcept
+            {
+                m_live += other.m_live;
+                m_reserved += other.m_reserved;
+                m_allocations += other.m_allocations;
+                m_frees += other.m_frees;
+                m_created += other.m_created;
+                m_destroyed += other.m_destroyed;
+                m_peak_live = std::max(m_peak_live, m_live);
+                m_peak_reserved = std::max(m_peak_reserved, m_reserved);
+            }
+        };
+
+        using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<slot>;
+        using slot_traits = std::allocator_traits<slot_allocator>;
+        using page_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<page>;
+
+        static constexpr std::size_t min_page_size = 16;
+        static constexpr std::size_t max_page_size = std::max<std::size_t>(min_page_size, (1 << 20) / sizeof(slot));
+
+        slot_allocator m_allocator;
+        std::vector<page, page_allocator> m_pages;
+        slot* m_free_list = nullptr;
+        std::size_t m_free_count = 0;
+        slot* m_unused_begin = nullptr;
+        slot* m_unused_end = nullptr;
+        std::size_t m_next_page_size = min_page_size;
+        [[no_unique_address]] std::conditional_t<allocation_stats, counters, no_field> m_stats;
+
+        slot* acquire()
+        {
+            if (m_free_list != nullptr)
+            {
+                --m_free_count;
+                return std::exchange(m_free_list, m_free_list->m_next_free);
+            }
+
+            if (m_unused_begin == m_unused_end)
+            {
+                add_page(m_next_page_size);
+                m_next_page_size = std::min(m_next_page_size * 2, max_page_size);
+            }
+
+            return m_unused_begin++;
+        }
+
+        void push_free(slot* s) noexcept
+        {
+            s->m_next_free = m_free_list;
+            m_free_list = s;
+            ++m_free_count;
+        }
+
+        // - the unused slots of the current page are kept in the free list
+        void add_page(std::size_t size)
+        {
+            slot* slots = slot_traits::allocate(m_allocator, size);
+
+            try
+            {
+                m_pages.push_back({slots, size});
+            }
+            catch (...)
+            {
+                slot_traits::deallocate(m_allocator, slots, size);
+                throw;
+            }
+
+            while (m_unused_begin != m_unused_end)
+                push_free(m_unused_begin++);
+
+            m_unused_begin = slots;
+            m_unused_end = slots + size;
+
+            if constexpr (allocation_stats)
+            {
+                ++m_stats.m_allocations;
+                m_stats.m_reserved += size;
+                m_stats.m_peak_reserved = std::max(m_stats.m_peak_reserved, m_stats.m_reserved);
+            }
+        }
+
+    public:
+        explicit node_pool(const Allocator& allocator) noexcept
+            : m_allocator(allocator), m_pages(page_allocator(allocator))
+        {
+        }
+
+        node_pool(node_pool&& rhs) noexcept
+            : m_allocator(std::move(rhs.m_allocator)), m_pages(std::move(rhs.m_pages)),
+              m_free_list(std::exchange(rhs.m_free_list, nullptr)), m_free_count(std::exchange(rhs.m_free_count, 0)),
+              m_unused_begin(std::exchange(rhs.m_unused_begin, nullptr)),
+              m_unused_end(std::exchange(rhs.m_unused_end, nullptr)),
+              m_next_page_size(std::exchange(rhs.m_next_page_size, min_page_size)),
+              m_stats(std::exchange(rhs.m_stats, {}))
+        {
+            rhs.m_pages.clear();
+        }
+
+        node_pool(const node_pool&) = delete;
+        node_pool& operator=(const node_pool&) = delete;
+
+        // - every node of this pool must have been destroyed before
+        // - the allocator of rhs is taken only if it propagates on move assignment, otherwise both must be equal
+        node_pool& operator=(node_pool&& rhs) noexcept
+        {
+            release();
+            if constexpr (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value)
+                m_allocator = std::move(rhs.m_allocator);
+
+            m_pages = std::move(rhs.m_pages);
+            rhs.m_pages.clear();
+            m_free_list = std::exchange(rhs.m_free_list, nullptr);
+            m_free_count = std::exchange(rhs.m_free_count, 0);
+            m_unused_begin = std::exchange(rhs.m_unused_begin, nullptr);
+            m_unused_end = std::exchange(rhs.m_unused_end, nullptr);
+            m_next_page_size = std::exchange(rhs.m_next_page_size, min_page_size);
+            m_stats = std::exchange(rhs.m_stats, {});
+            return *this;
+        }
+
+        // - the allocators are exchanged only if they propagate on swap, otherwise both must be equal
+        void swap(node_pool& other) noexcept
+        {
+            using std::swap;
+            if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value)
+                swap(m_allocator, other.m_allocator);
+
+            m_pages.swap(other.m_pages);
+            swap(m_free_list, other.m_free_list);
+            swap(m_free_count, other.m_free_count);
+            swap(m_unused_begin, other.m_unused_begin);
+            swap(m_unused_end, other.m_unused_end);
+            swap(m_next_page_size, other.m_next_page_size);
+            swap(m_stats, other.m_stats);
+        }
+
+        ~node_pool()
+        {
+            release();
+        }
+
+        [[nodiscard]] Allocator get_allocator() const noexcept
+        {
+            return Allocator(m_allocator);
+        }
+
+        // - makes room for count nodes; when the free slots are not enough, they all go to a single new page, carved
+        //   in order once the free list is exhausted, which also takes its turn in the geometric growth of the pages
+        void reserve(std::size_t count)
+        {
+            if (m_free_count + static_cast<std::size_t>(m_unused_end - m_unused_begin) >= count)
+                return;
+
+            add_page(std::max(count, m_next_page_size));
+            m_next_page_size = std::min(m_next_page_size * 2, max_page_size);
+        }
+
+        template <typename... Args>
+        private_node* create(Args&&... args)
+        {
+            slot* s = acquire();
+            private_node* pnode;
+            try
+            {
+                pnode = ::new (static_cast<void*>(s->m_storage)) private_node(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                push_free(s);
+                throw;
+            }
+
+            if constexpr (allocation_stats)
+            {
+                ++m_stats.m_created;
+                m_stats.m_peak_live = std::max(m_stats.m_peak_live, ++m_stats.m_live);
+            }
+            return pnode;
+        }
+
+        void destroy(private_node* pnode) noexcept
+        {
+            pnode->~private_node();
+            push_free(reinterpret_cast<slot*>(pnode));
+
+            if constexpr (allocation_stats)
+            {
+                ++m_stats.m_destroyed;
+                --m_stats.m_live;
+            }
+        }
+
+        // - every node must have been destroyed before
+        void reset(const Allocator& allocator) noexcept
+        {
+            release();
+            m_allocator = slot_allocator(allocator);
+            std::destroy_at(&m_pages);
+            std::construct_at(&m_pages, page_allocator(allocator));
+        }
+
+        // - every node must have been destroyed before, or need no destruction
+        void release() noexcept
+        {
+            if constexpr (allocation_stats)
+            {
+                m_stats.m_frees += m_pages.size();
+                m_stats.m_destroyed += m_stats.m_live;
+                m_stats.m_live = 0;
+                m_stats.m_reserved = 0;
+            }
+
+            for (const page& p : m_pages)
+                slot_traits::deallocate(m_allocator, p.m_slots, p.m_size);
+
+            std::vector<page, page_allocator>(m_pages.get_allocator()).swap(m_pages);
+            m_free_list = nullptr;
+            m_free_count = 0;
+            m_unused_begin = nullptr;
+            m_unused_end = nullptr;
+            m_next_page_size = min_page_size;
+        }
+
+        // - takes ownership of every page of other, which must use an equal allocator
+        // - live nodes of other keep their addresses
+        void merge(node_pool& other)
+        {
+            m_pages.reserve(m_pages.size() + other.m_pages.size());
+            m_pages.insert(m_pages.end(), other.m_pages.begin(), other.m_pages.end());
+            other.m_pages.clear();
+
+            while (other.m_free_list != nullptr)
+                push_free(std::exchange(other.m_free_list, other.m_free_list->m_next_free));
+
+            while (other.m_unused_begin != other.m_unused_end)
+                push_free(other.m_unused_begin++);
+
+            if constexpr (allocation_stats)
+                m_stats.absorb(std::exchange(other.m_stats, {}));
+
+            other.release();
+        }
+
+        [[nodiscard]] tree_memory_stats stats() const noexcept
+        {
+            tree_memory_stats result;
+            if constexpr (allocation_stats)
+            {
+                result.live_nodes = m_stats.m_live;
+                result.peak_live_nodes = m_stats.m_peak_live;
+                result.bytes_used = m_stats.m_live * sizeof(slot);
+                result.peak_bytes_used = m_stats.m_peak_live * sizeof(slot);
+                result.bytes_reserved = m_stats.m_reserved * sizeof(slot);
+                result.peak_bytes_reserved = m_stats.m_peak_reserved * sizeof(slot);
+                result.allocations = m_stats.m_allocations;
+                result.frees = m_stats.m_frees;
+                result.nodes_created = m_stats.m_created;
+                result.nodes_destroyed = m_stats.m_destroyed;
+            }
+            return result;
+        }
+    };
+
+    node_pool m_pool;
+    private_node* m_root;
+
+    // - returns the root of a tree whose nodes are owned by this tree's pool
+    // - other is left empty
+    private_node* adopt(general_tree& other)
+    {
+        if (m_pool.get_allocator() == other.m_pool.get_allocator())
+        {
+            m_pool.merge(other.m_pool);
+            return std::exchange(other.m_root, nullptr);
+        }
+
+        // storage cannot be shared, move the values into nodes of this pool
+        general_tree moved(get_allocator());
+        moved.deep_copy(other.root(), [](T& value) -> T&& { return std::move(value); });
+        other.clear();
+        m_pool.merge(moved.m_pool);
+        return std::exchange(moved.m_root, nullptr);
+    }
+
+    // - next node of the subtree rooted at subtree_root in pre-order, or nullptr
+    static private_node* next_preorder(private_node* current, const private_node* subtree_root) noexcept
+    {
+        if (current->m_left_child != nullptr)
+            return current->m_left_child;
+
+        while (current != subtree_root)
+        {
+            if (current->m_right_sibling != nullptr)
+                return current->m_right_sibling;
+            current = current->m_parent;
+        }
+
+        return nullptr;
+    }
+
+    static private_node* leftmost_leaf(private_node* current) noexcept
+    {
+        while (current->m_left_child != nullptr)
+            current = current->m_left_child;
+        return current;
+    }
+
+    // - next node of the subtree rooted at subtree_root in post-order, or nullptr
+    static private_node* next_postorder(private_node* current, const private_node* subtree_root) noexcept
+    {
+        if (current == subtree_root)
+            return nullptr;
+
+        if (current->m_right_sibling != nullptr)
+            return leftmost_leaf(current->m_right_sibling);
+
+        return current->m_parent;
+    }
+
+    static void prefetch([[maybe_unused]] const private_node* pnode) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(pnode);
+#endif
+    }
+
+    // - callbacks returning void never stop a visit, any other result stops it once it converts to false
+    template <typename F>
+    static bool visit_node(F& f, private_node* pnode)
+    {
+        if constexpr (std::is_void_v<std::invoke_result_t<F&, node>>)
+        {
+            f(node(pnode));
+            return true;
+        }
+        else
+            return static_cast<bool>(f(node(pnode)));
+    }
+
+    struct preorder_traversal
+    {
+        static private_node* first(private_node* subtree_root) noexcept
+        {
+            return subtree_root;
+        }
+
+        static private_node* next(private_node* current, const private_node* subtree_root) noexcept
+        {
+            return next_preorder(current, subtree_root);
+        }
+    };
+
+    struct postorder_traversal
+    {
+        static private_node* first(private_node* subtree_root) noexcept
+        {
+            return subtree_root == nullptr ? nullptr : leftmost_leaf(subtree_root);
+        }
+
+        static private_node* next(private_node* current, const private_node* subtree_root) noexcept
+        {
+            return next_postorder(current, subtree_root);
+        }
+    };
+
+    // Every structural change goes through the link / unlink functions below, which keep the optional
+    // per-node bookkeeping selected by Features up to date
+
+    // - makes room in the index of parent for count more children, before or after the others, so that linking them
+    //   cannot throw; every link function below needs room for the children it adds
+    static void reserve_children(private_node* parent, std::size_t count, bool front)
+    {
+        if constexpr (indexed_children)
+            parent->m_children_index.reserve(count, front);
+    }
+
+    // - room for as many children as original has, for a copy of original that has no children yet
+    static void reserve_children_like(private_node* copy, const private_node* original)
+    {
+        if constexpr (indexed_children)
+            copy->m_children_index.reserve(original->m_children_index.m_count, false);
+    }
+
+    // - child may be the root of a whole subtree
+    static void set_left_sibling(private_node* pnode, private_node* left_sibling) noexcept
+    {
+        if constexpr (left_sibling_links)
+        {
+            if (pnode != nullptr)
+                pnode->m_left_sibling = left_sibling;
+        }
+    }
+
+    static void link_left_child(private_node* parent, private_node* child) noexcept
+    {
+        if (parent->m_left_child == nullptr)
+            parent->m_last_child = child;
+
+        set_left_sibling(parent->m_left_child, child);
+        set_left_sibling(child, nullptr);
+        child->m_parent = parent;
+        child->m_right_sibling = parent->m_left_child;
+        parent->m_left_child = child;
+        if constexpr (indexed_children)
+            parent->m_children_index.insert(child, 1, true);
+    }
+
+    // - child may be the root of a whole subtree
+    static void link_last_child(private_node* parent, private_node* child) noexcept
+    {
+        if (parent->m_last_child == nullptr)
+            parent->m_left_child = child;
+        else
+            parent->m_last_child->m_right_sibling = child;
+
+        set_left_sibling(child, parent->m_last_child);
+        child->m_parent = parent;
+        child->m_right_sibling = nullptr;
+        parent->m_last_child = child;
+        if constexpr (indexed_children)
+            parent->m_children_index.insert(child, 1, false);
+    }
+
+    // - sibling may be the root of a whole subtree
+    static void link_right_sibling(private_node* pnode, private_node* sibling) noexcept
+    {
+        if (pnode->m_right_sibling == nullptr)
+            pnode->m_parent->m_last_child = sibling;
+
+        set_left_sibling(pnode->m_right_sibling, sibling);
+        set_left_sibling(sibling, pnode);
+        sibling->m_parent = pnode->m_parent;
+        sibling->m_right_sibling = pnode->m_right_sibling;
+        pnode->m_right_sibling = sibling;
+        if constexpr (indexed_children)
+            pnode->m_parent->m_children_index.insert_after(pnode, sibling);
+    }
+
+    // - O(1) with left sibling links, otherwise O(position) by scanning from the first child of the parent
+    static private_node* find_left_sibling(const private_node* pnode) noexcept
+    {
+        if constexpr (left_sibling_links)
+            return pnode->m_left_sibling;
+        else
+        {
+            if (pnode->m_parent == nullptr || pnode == pnode->m_parent->m_left_child)
+                return nullptr;
+
+            private_node* left_sibling = pnode->m_parent->m_left_child;
+            while (left_sibling->m_right_sibling != pnode)
+                left_sibling = left_sibling->m_right_sibling;
+            return left_sibling;
+        }
+    }
+
+    // - detaches pnode, with all its descendants, from its parent and siblings
+    // - left_sibling must be the left sibling of pnode, it is looked up when not provided
+    static void unlink(private_node* pnode, private_node* left_sibling) noexcept
+    {
+        private_node* parent = pnode->m_parent;
+        if (parent == nullptr)
+            return;
+
+        if (left_sibling == nullptr)
+            // set new left child
+            parent->m_left_child = pnode->m_right_sibling;
+        else
+            left_sibling->m_right_sibling = pnode->m_right_sibling;
+
+        set_left_sibling(pnode->m_right_sibling, left_sibling);
+
+        if (pnode == parent->m_last_child)
+            parent->m_last_child = left_sibling;
+
+        pnode->m_parent = nullptr;
+        pnode->m_right_sibling = nullptr;
+        set_left_sibling(pnode, nullptr);
+        if constexpr (indexed_children)
+            parent->m_children_index.erase(pnode);
+    }
+
+    // The bookkeeping kept along the chain of ancestors is refreshed by the public operations once a subtree is
+    // linked or unlinked. Copies take it from the original nodes instead
+
+    static std::size_t hash_combine(std::size_t seed, std::size_t value) noexcept
+    {
+        return seed ^ (value + static_cast<std::size_t>(0x9e3779b97f4a7c15ull) + (seed << 6) + (seed >> 2));
+    }
+
+    // The structural hash of a node combines the hash of its value with a polynomial over the hashes of its children,
+    // kept in hash_field. Dividing the sum by the weight of the first child makes it independent of the power the
+    // weights start from, so a child added or removed at either end, or a child whose hash changed, only adds a delta
+    // to the sum of its parent and every ancestor is updated in O(1). Children added or removed in the middle shift
+    // the weights of their right siblings
+
+    static constexpr std::size_t hash_base = static_cast<std::size_t>(0x100000001b3ull);
+
+    // - inverse modulo 2^N of an odd number by Newton's iteration: x * x == 1 modulo 8 for every odd x, and every step
+    //   doubles the number of correct low bits
+    static constexpr std::size_t odd_inverse(std::size_t x) noexcept
+    {
+        std::size_t inverse = x;
+        for (int bits = 3; bits < std::numeric_limits<std::size_t>::digits; bits *= 2)
+            inverse *= 2 - x * inverse;
+        return inverse;
+    }
+
+    static constexpr std::size_t hash_base_inverse = odd_inverse(hash_base);
+
+    // - the sums of the children must be up to date
+    static std::size_t subtree_hash_of(const private_node* pnode) noexcept
+    {
+        std::size_t children = 0;
+        if (pnode->m_left_child != nullptr)
+            children = pnode->m_hash.m_children * odd_inverse(pnode->m_left_child->m_hash.m_weight);
+        return hash_combine(std::hash<T>{}(pnode->m_data), children);
+    }
+
+    // - recomputes the hash of pnode and carries the change up to the root, O(depth)
+    static void refresh_hash(private_node* pnode) noexcept
+    {
+        std::size_t old = std::exchange(pnode->m_hash.m_value, subtree_hash_of(pnode));
+        for (private_node* current = pnode; current->m_parent != nullptr && current->m_hash.m_value != old;
+             current = current->m_parent)
+        {
+            private_node* parent = current->m_parent;
+            parent->m_hash.m_children += (current->m_hash.m_value - old) * current->m_hash.m_weight;
+            old = std::exchange(parent->m_hash.m_value, subtree_hash_of(parent));
+        }
+    }
+
+    // - multiplies the weights of first and its right siblings by factor
+    static void shift_hash_weights(private_node* parent, private_node* first, std::size_t factor) noexcept
+    {
+        for (private_node* current = first; current != nullptr; current = current->m_right_sibling)
+        {
+            const std::size_t weight = current->m_hash.m_weight * factor;
+            parent->m_hash.m_children += current->m_hash.m_value * (weight - current->m_hash.m_weight);
+            current->m_hash.m_weight = weight;
+        }
+    }
+
+    // - the count subtrees starting at first must be linked as consecutive children and have up to date hashes
+    static void hash_children_attached(private_node* first, std::size_t count) noexcept
+    {
+        private_node* parent = first->m_parent;
+        private_node* end = first;
+        std::size_t factor = 1;
+        for (std::size_t i = 0; i < count; i++, end = end->m_right_sibling)
+            factor *= hash_base;
+
+        std::size_t weight;
+        if (end == nullptr)
+        {
+            weight = parent->m_hash.m_next_weight;
+            parent->m_hash.m_next_weight *= factor;
+        }
+        else if (first == parent->m_left_child)
+            weight = end->m_hash.m_weight * odd_inverse(factor);
+        else
+        {
+            weight = end->m_hash.m_weight;
+            shift_hash_weights(parent, end, factor);
+            parent->m_hash.m_next_weight *= factor;
+        }
+
+        for (private_node* current = first; current != end; current = current->m_right_sibling, weight *= hash_base)
+        {
+            current->m_hash.m_weight = weight;
+            parent->m_hash.m_children += current->m_hash.m_value * weight;
+        }
+        refresh_hash(parent);
+    }
+
+    // - subtree must be already unlinked from parent, right_sibling is its former right sibling
+    static void hash_subtree_detached(private_node* parent, const private_node* subtree,
+                                      private_node* right_sibling) noexcept
+    {
+        parent->m_hash.m_children -= subtree->m_hash.m_value * subtree->m_hash.m_weight;
+        if (right_sibling == nullptr)
+            parent->m_hash.m_next_weight = subtree->m_hash.m_weight;
+        else if (right_sibling != parent->m_left_child)
+        {
+            shift_hash_weights(parent, right_sibling, hash_base_inverse);
+            parent->m_hash.m_next_weight *= hash_base_inverse;
+        }
+        refresh_hash(parent);
+    }
+
+    // - numbers the children of pnode from scratch, their hashes must be up to date; does not touch the ancestors
+    static void rehash(private_node* pnode) noexcept
+    {
+        std::size_t weight = 1;
+        pnode->m_hash.m_children = 0;
+        for (private_node* child = pnode->m_left_child; child != nullptr; child = child->m_right_sibling)
+        {
+            child->m_hash.m_weight = weight;
+            pnode->m_hash.m_children += child->m_hash.m_value * weight;
+            weight *= hash_base;
+        }
+        pnode->m_hash.m_next_weight = weight;
+        pnode->m_hash.m_value = subtree_hash_of(pnode);
+    }
+
+    // - the aggregates of the children must be up to date
+    static void refresh_aggregate(private_node* pnode) noexcept
+    {
+        auto aggregate = Augmentation::from_value(pnode->m_data);
+        for (const private_node* child = pnode->m_left_child; child != nullptr; child = child->m_right_sibling)
+            aggregate = Augmentation::combine(aggregate, child->m_aggregate.m_value);
+        pnode->m_aggregate.m_value = std::move(aggregate);
+    }
+
+    // - refreshes the aggregates from pnode up to the root, or only marks them when they are computed lazily
+    static void aggregates_changed(private_node* pnode) noexcept
+    {
+        if constexpr (lazy_augmentation)
+        {
+            for (private_node* current = pnode; current != nullptr && !current->m_aggregate.m_dirty;
+                 current = current->m_parent)
+                current->m_aggregate.m_dirty = true;
+        }
+        else if constexpr (augmented)
+        {
+            for (private_node* current = pnode; current != nullptr; current = current->m_parent)
+                refresh_aggregate(current);
+        }
+    }
+
+    // - recomputes the dirty aggregates of the subtree in one post-order pass, skipping the clean subtrees
+    static void clean_aggregates(private_node* subtree) noexcept
+    {
+        auto first_dirty = [](private_node* current) {
+            while (current != nullptr && !current->m_aggregate.m_dirty)
+                current = current->m_right_sibling;
+            return current;
+        };
+
+        private_node* current = subtree;
+        while (true)
+        {
+            if (private_node* child = first_dirty(current->m_left_child); child != nullptr)
+            {
+                current = child;
+                continue;
+            }
+
+            refresh_aggregate(current);
+            current->m_aggregate.m_dirty = false;
+            if (current == subtree)
+                return;
+
+            // the parent is still dirty, so it is finished once none of its children are
+            private_node* sibling = first_dirty(current->m_right_sibling);
+            current = sibling != nullptr ? sibling : current->m_parent;
+        }
+    }
+
+    // - subtree must be already linked
+    static void subtree_attached(private_node* subtree) noexcept
+    {
+        if constexpr (subtree_sizes)
+        {
+            for (private_node* ancestor = subtree->m_parent; ancestor != nullptr; ancestor = ancestor->m_parent)
+                ancestor->m_subtree_size += subtree->m_subtree_size;
+        }
+
+        if constexpr (cached_depth)
+        {
+            // a new node is a leaf, so this is only a walk when a whole tree is spliced in
+            subtree->m_depth = subtree->m_parent->m_depth + 1;
+            for (private_node* current = next_preorder(subtree, subtree); current != nullptr;
+                 current = next_preorder(current, subtree))
+                current->m_depth = current->m_parent->m_depth + 1;
+        }
+
+        if constexpr (structural_hash)
+            hash_children_attached(subtree, 1);
+
+        aggregates_changed(subtree->m_parent);
+    }
+
+    // - the count leaves starting at first must be already linked as consecutive children of their parent
+    static void children_attached(private_node* first, std::size_t count) noexcept
+    {
+        private_node* parent = first->m_parent;
+
+        if constexpr (subtree_sizes)
+        {
+            for (private_node* ancestor = parent; ancestor != nullptr; ancestor = ancestor->m_parent)
+                ancestor->m_subtree_size += count;
+        }
+
+        if constexpr (cached_depth)
+        {
+            private_node* current = first;
+            for (std::size_t i = 0; i < count; i++, current = current->m_right_sibling)
+                current->m_depth = parent->m_depth + 1;
+        }
+
+        if constexpr (structural_hash)
+            hash_children_attached(first, count);
+
+        aggregates_changed(parent);
+    }
+
+    // - subtree must be already unlinked from parent, right_sibling is its former right sibling
+    static void subtree_detached(private_node* parent, const private_node* subtree,
+                                 private_node* right_sibling) noexcept
+    {
+        if (parent == nullptr)
+            return;
+
+        if constexpr (subtree_sizes)
+        {
+            for (private_node* ancestor = parent; ancestor != nullptr; ancestor = ancestor->m_parent)
+                ancestor->m_subtree_size -= subtree->m_subtree_size;
+        }
+
+        if constexpr (structural_hash)
+            hash_subtree_detached(parent, subtree, right_sibling);
+
+        aggregates_changed(parent);
+    }
+
+    // - the value of pnode has been replaced
+    static void data_changed(private_node* pnode) noexcept
+    {
+        if constexpr (structural_hash)
+            refresh_hash(pnode);
+
+        aggregates_changed(pnode);
+    }
+
+    // - recomputes the bookkeeping of a whole subtree at once, for trees linked without going through
+    //   subtree_attached
+    static void rebuild_bookkeeping(private_node* subtree) noexcept
+    {
+        if constexpr (cached_depth)
+        {
+            subtree->m_depth = subtree->m_parent == nullptr ? 0 : subtree->m_parent->m_depth + 1;
+            for (private_node* current = next_preorder(subtree, subtree); current != nullptr;
+                 current = next_preorder(current, subtree))
+                current->m_depth = current->m_parent->m_depth + 1;
+        }
+
+        if constexpr (subtree_sizes || structural_hash || augmented)
+        {
+            // children are visited before their parent
+            for (private_node* current = leftmost_leaf(subtree); current != nullptr;
+                 current = next_postorder(current, subtree))
+            {
+                if constexpr (subtree_sizes)
+                {
+                    current->m_subtree_size = 1;
+                    for (private_node* child = current->m_left_child; child != nullptr; child = child->m_right_sibling)
+                        current->m_subtree_size += child->m_subtree_size;
+                }
+                if constexpr (structural_hash)
+                    rehash(current);
+                if constexpr (augmented)
+                    refresh_aggregate(current);
+                if constexpr (lazy_augmentation)
+                    current->m_aggregate.m_dirty = false;
+            }
+        }
+    }
+
+    static void copy_bookkeeping(private_node* copy, const private_node* original) noexcept
+    {
+        if constexpr (subtree_sizes)
+            copy->m_subtree_size = original->m_subtree_size;
+        if constexpr (cached_depth)
+            copy->m_depth = original->m_depth;
+        if constexpr (structural_hash)
+            copy->m_hash = original->m_hash;
+        if constexpr (augmented)
+            copy->m_aggregate = original->m_aggregate;
+    }
+
+    // - handles null node
+    // - sets the pointers to nullptr
+    void delete_from_node(private_node* pnode, private_node* left_sibling)
+    {
+        if (pnode == nullptr)
+            return;
+
+        private_node* parent = pnode->m_parent;
+        private_node* right_sibling = pnode->m_right_sibling;
+        unlink(pnode, left_sibling);
+        subtree_detached(parent, pnode, right_sibling);
+        destroy_subtree(pnode);
+    }
+
+    void delete_from_node(private_node* pnode)
+    {
+        if (pnode != nullptr)
+            delete_from_node(pnode, find_left_sibling(pnode));
+    }
+
+    // - builds a chain of new leaves, one per element, and links it before the first or after the last child
+    template <typename Range>
+    sibling_range emplace_children(private_node* parent, Range&& values, bool front)
+    {
+        if constexpr (std::ranges::forward_range<Range>)
+            m_pool.reserve(static_cast<std::size_t>(std::ranges::distance(values)));
+
+        private_node* first = nullptr;
+        private_node* last = nullptr;
+        std::size_t count = 0;
+
+        try
+        {
+            for (auto&& value : values)
+            {
+                private_node* new_node = m_pool.create(std::forward<decltype(value)>(value));
+                new_node->m_parent = parent;
+                set_left_sibling(new_node, last);
+                if (last == nullptr)
+                    first = new_node;
+                else
+                    last->m_right_sibling = new_node;
+                last = new_node;
+                ++count;
+            }
+
+            reserve_children(parent, count, front);
+        }
+        catch (...)
+        {
+            while (first != nullptr)
+                m_pool.destroy(std::exchange(first, first->m_right_sibling));
+            throw;
+        }
+
+        if (count == 0)
+            return sibling_range();
+
+        private_node* end;
+        if (front)
+        {
+            end = parent->m_left_child;
+            last->m_right_sibling = end;
+            set_left_sibling(end, last);
+            if (end == nullptr)
+                parent->m_last_child = last;
+            parent->m_left_child = first;
+        }
+        else
+        {
+            end = nullptr;
+            set_left_sibling(first, parent->m_last_child);
+            if (parent->m_last_child == nullptr)
+                parent->m_left_child = first;
+            else
+                parent->m_last_child->m_right_sibling = first;
+            parent->m_last_child = last;
+        }
+
+        if constexpr (indexed_children)
+            parent->m_children_index.insert(first, count, front);
+        children_attached(first, count);
+        return sibling_range(first, end);
+    }
+
+    // - pnode must be already unlinked from its parent and siblings
+    void destroy_subtree(private_node* pnode) noexcept
+    {
+        // In-place rotation over the left child / right sibling links
+        // A node with a single link is destroyed and the walk follows that link. A node with both links is rotated
+        // with its left child, which moves the child's siblings under it. No extra memory is needed and nodes are
+        // mostly destroyed top-down, in the order they were reached
+        // Only the two links are rewritten, the optional bookkeeping of the doomed nodes is left stale
+
+        private_node* current = pnode;
+        while (current != nullptr)
+        {
+            private_node* next;
+
+            if (current->m_left_child == nullptr)
+                next = current->m_right_sibling;
+            else if (current->m_right_sibling == nullptr)
+                next = current->m_left_child;
+            else
+            {
+                next = current->m_left_child;
+                current->m_left_child = next->m_right_sibling;
+                next->m_right_sibling = current;
+                current = next;
+                continue;
+            }
+
+            m_pool.destroy(current);
+            current = next;
+        }
+    }
+
+    template <typename Projection>
+    void deep_copy(node n, Projection project)
+    {
+        // Pre-order walk over the original, mirrored on the copy
+        // The parent links of both trees are used to climb back, no extra memory is needed
+        if (n.m_node == nullptr)
+            return;
+
+        private_node* const original_root = n.m_node;
+        private_node* original = original_root;
+        private_node* copy = m_pool.create(project(original->m_data));
+        copy_bookkeeping(copy, original);
+        m_root = copy;
+
+        while (true)
+        {
+            if (original->m_left_child != nullptr)
+            {
+                reserve_children_like(copy, original);
+                original = original->m_left_child;
+                private_node* child_copy = m_pool.create(project(original->m_data));
+                copy_bookkeeping(child_copy, original);
+                link_left_child(copy, child_copy);
+                copy = child_copy;
+                continue;
+            }
+
+            while (original != original_root && original->m_right_sibling == nullptr)
+            {
+                original = original->m_parent;
+                copy = copy->m_parent;
+            }
+
+            if (original == original_root)
+                return;
+
+            original = original->m_right_sibling;
+            private_node* sibling_copy = m_pool.create(project(original->m_data));
+            copy_bookkeeping(sibling_copy, original);
+            link_right_sibling(copy, sibling_copy);
+            copy = sibling_copy;
+        }
+    }
+
+    void deep_copy(node n)
+    {
+        deep_copy(n, [](const T& value) -> const T& { return value; });
+    }
+
+    // - copy_root is the already linked copy of original_root, its descendants are copied into the worker's pool
+    // - right siblings with children are handed to other workers while some of them are idle; the sibling copy is
+    //   linked before being handed, so the order is preserved and every node is only written by one worker
+    template <typename Worker>
+    static void parallel_copy_subtree(std::vector<node_pool>& pools, const private_node* original_root,
+                                      private_node* copy_root, Worker& worker)
+    {
+        node_pool& pool = pools[worker.index()];
+        const private_node* original = original_root;
+        private_node* copy = copy_root;
+        bool descend = true;
+
+        while (true)
+        {
+            if (descend && original->m_left_child != nullptr)
+            {
+                reserve_children_like(copy, original);
+                original = original->m_left_child;
+                private_node* child_copy = pool.create(original->m_data);
+                copy_bookkeeping(child_copy, original);
+                link_left_child(copy, child_copy);
+                copy = child_copy;
+                continue;
+            }
+
+            while (original != original_root && original->m_right_sibling == nullptr)
+            {
+                original = original->m_parent;
+                copy = copy->m_parent;
+            }
+
+            if (original == original_root)
+                return;
+
+            original = original->m_right_sibling;
+            private_node* sibling_copy = pool.create(original->m_data);
+            copy_bookkeeping(sibling_copy, original);
+            link_right_sibling(copy, sibling_copy);
+            copy = sibling_copy;
+
+            descend = original->m_left_child == nullptr || !worker.hungry();
+            if (!descend)
+            {
+                worker.spawn([&pools, original, sibling_copy](Worker& thief) {
+                    parallel_copy_subtree(pools, original, sibling_copy, thief);
+                });
+            }
+        }
+    }
+
+    // nodes handed to f by a parallel_for_each task before it checks again for idle workers
+    static constexpr std::size_t parallel_batch_size = 64;
+
+    // - subtrees big enough to be worth a task of their own; without sizes any inner node is a candidate
+    static bool worth_spawning(const private_node* pnode) noexcept
+    {
+        if constexpr (subtree_sizes)
+            return pnode->m_subtree_size >= parallel_batch_size;
+        else
+            return pnode->m_left_child != nullptr;
+    }
+
+    // - walks the subtree in pre-order, handing right siblings worth it to idle workers as whole subtrees, and the
+    //   nodes gathered so far as a batch, so that chains and wide fans are split as well
+    template <typename F, typename Worker>
+    static void parallel_for_each_subtree(private_node* subtree_root, F& f, Worker& worker)
+    {
+        std::vector<private_node*> batch;
+        batch.reserve(parallel_batch_size);
+
+        auto flush = [&] {
+            if (worker.hungry())
+            {
+                worker.spawn([&f, nodes = std::move(batch)](Worker&) {
+                    for (private_node* pnode : nodes)
+                        f(node(pnode));
+                });
+                batch = std::vector<private_node*>();
+                batch.reserve(parallel_batch_size);
+            }
+            else
+            {
+                for (private_node* pnode : batch)
+                    f(node(pnode));
+                batch.clear();
+            }
+        };
+
+        private_node* current = subtree_root;
+        bool visit = true;
+
+        while (true)
+        {
+            if (visit)
+            {
+                batch.push_back(current);
+                if (batch.size() == parallel_batch_size)
+                    flush();
+
+                if (current->m_left_child != nullptr)
+                {
+                    current = current->m_left_child;
+                    continue;
+                }
+            }
+
+            while (current != subtree_root && current->m_right_sibling == nullptr)
+                current = current->m_parent;
+
+            if (current == subtree_root)
+                break;
+
+            current = current->m_right_sibling;
+            visit = !(worth_spawning(current) && worker.hungry());
+            if (!visit)
+            {
+                worker.spawn([&f, sibling = current](Worker& thief) {
+                    parallel_for_each_subtree(sibling, f, thief);
+                });
+            }
+        }
+
+        for (private_node* pnode : batch)
+            f(node(pnode));
+    }
+
+    // nodes mapped by a parallel_reduce task before it checks again for idle workers
+    static constexpr std::size_t parallel_reduce_grain = 256;
+
+    // - the subtree laid out in pre-order positions, with the links needed to fold it bottom-up in any order
+    struct reduce_layout
+    {
+        static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+        std::vector<private_node*> m_nodes;
+        std::vector<std::size_t> m_parents;
+        std::vector<std::size_t> m_next_siblings;
+        // own result plus the results of the children still missing
+        std::vector<std::atomic<std::size_t>> m_pending;
+
+        explicit reduce_layout(private_node* subtree_root)
+        {
+            const std::size_t size = node(subtree_root).descendants_count() + 1;
+            m_nodes.reserve(size);
+            m_parents.reserve(size);
+            m_next_siblings.reserve(size);
+            m_pending = std::vector<std::atomic<std::size_t>>(size);
+
+            std::size_t position = add(subtree_root, none);
+            private_node* current = subtree_root;
+
+            while (true)
+            {
+                if (current->m_left_child != nullptr)
+                {
+                    current = current->m_left_child;
+                    position = add(current, position);
+                    continue;
+                }
+
+                while (current != subtree_root && current->m_right_sibling == nullptr)
+                {
+                    current = current->m_parent;
+                    position = m_parents[position];
+                }
+
+                if (current == subtree_root)
+                    return;
+
+                current = current->m_right_sibling;
+                const std::size_t sibling = add(current, m_parents[position]);
+                m_next_siblings[position] = sibling;
+                position = sibling;
+            }
+        }
+
+        std::size_t add(private_node* pnode, std::size_t parent)
+        {
+            const std::size_t position = m_nodes.size();
+            m_nodes.push_back(pnode);
+            m_parents.push_back(parent);
+            m_next_siblings.push_back(none);
+            m_pending[position].store(1, std::memory_order_relaxed);
+            if (parent != none)
+                m_pending[parent].fetch_add(1, std::memory_order_relaxed);
+            return position;
+        }
+    };
+
+    // - one result per node; the wrapper keeps results of distinct nodes in distinct objects, which
+    //   std::vector<bool> would pack into shared words written by several workers
+    template <typename R>
+    struct reduce_slot
+    {
+        R m_value;
+    };
+
+    // - maps the nodes at positions [begin, end), handing the upper half of what is left to idle workers
+    // - whoever completes the last piece of a node folds its children into it, in sibling order, and moves on to the
+    //   parent, so the fold climbs as far as the results allow without waiting for anything
+    template <typename R, typename Map, typename Combine, typename Worker>
+    static void parallel_reduce_range(reduce_layout& layout, reduce_slot<R>* results, Map& map, Combine& combine,
+                                      bool keep_results, std::size_t begin, std::size_t end, Worker& worker)
+    {
+        while (begin != end)
+        {
+            if (end - begin > parallel_reduce_grain && worker.hungry())
+            {
+                const std::size_t middle = begin + (end - begin) / 2;
+                worker.spawn([&layout, results, &map, &combine, keep_results, middle, end](Worker& thief) {
+                    parallel_reduce_range(layout, results, map, combine, keep_results, middle, end, thief);
+                });
+                end = middle;
+            }
+
+            const std::size_t chunk_end = std::min(end, begin + parallel_reduce_grain);
+            for (; begin != chunk_end; ++begin)
+            {
+                results[begin].m_value = map(node(layout.m_nodes[begin]));
+
+                for (std::size_t position = begin;
+                     layout.m_pending[position].fetch_sub(1, std::memory_order_acq_rel) == 1;)
+                {
+                    if (layout.m_nodes[position]->m_left_child != nullptr)
+                    {
+                        R folded = std::move(results[position].m_value);
+                        for (std::size_t child = position + 1; child != reduce_layout::none;
+                             child = layout.m_next_siblings[child])
+                        {
+                            if (keep_results)
+                                folded = combine(std::move(folded), results[child].m_value);
+                            else
+                                folded = combine(std::move(folded), std::move(results[child].m_value));
+                        }
+                        results[position].m_value = std::move(folded);
+                    }
+
+                    position = layout.m_parents[position];
+                    if (position == reduce_layout::none)
+                        break;
+                }
+            }
+        }
+    }
+
+    // - returns the result of every node of the subtree in pre-order, and their number through size
+    template <typename R, typename Executor, typename Map, typename Combine>
+    std::unique_ptr<reduce_slot<R>[]> parallel_reduce_into(node n, Executor& executor, Map& map, Combine& combine,
+                                                           bool keep_results, std::size_t& size) const
+    {
+        static_assert(std::is_default_constructible_v<R>, "parallel_reduce() requires default constructible results");
+
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot reduce null node");
+
+        reduce_layout layout(n.m_node);
+        size = layout.m_nodes.size();
+        auto results = std::make_unique<reduce_slot<R>[]>(size);
+
+        executor.run([&layout, slots = results.get(), &map, &combine, keep_results, size](auto& worker) {
+            parallel_reduce_range(layout, slots, map, combine, keep_results, 0, size, worker);
+        });
+        return results;
+    }
+
+public:
+    /**
+     * @brief Forward iterator over the values of a subtree in depth-first order.
+     *
+     * Advances through the parent links of the nodes, so it never allocates and each step is O(1) amortized.
+     * Iterators remain valid as long as the current node and the subtree root are not deleted.
+     */
+    template <typename Order, bool Const>
+    class traversal_iterator
+    {
+    private:
+        private_node* m_current = nullptr;
+        private_node* m_subtree_root = nullptr;
+        friend class general_tree;
+
+        traversal_iterator(private_node* subtree_root) noexcept
+            : m_current(Order::first(subtree_root)), m_subtree_root(subtree_root)
+        {
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const || !mutable_values, const T*, T*>;
+        using reference = std::conditional_t<Const || !mutable_values, const T&, T&>;
+
+        traversal_iterator() noexcept = default;
+
+        template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        traversal_iterator(const traversal_iterator<Order, OtherConst>& other) noexcept
+            : m_current(other.m_current), m_subtree_root(other.m_subtree_root)
+        {
+        }
+
+        reference operator*() const noexcept
+        {
+            return m_current->m_data;
+        }
+
+        pointer operator->() const noexcept
+        {
+            return &m_current->m_data;
+        }
+
+        traversal_iterator& operator++() noexcept
+        {
+            m_current = Order::next(m_current, m_subtree_root);
+            return *this;
+        }
 
-private:
-    struct private_node
-    {
-        T m_data;
-        private_node* m_right_sibling;
-        private_node* m_left_child;
-        private_node* m_parent;
+        traversal_iterator operator++(int) noexcept
+        {
+            traversal_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
 
-        template <typename... Args>
-        private_node(Args&&... args)
-            : m_right_sibling(nullptr), m_left_child(nullptr), m_parent(nullptr), m_data(std::forward<Args>(args)...)
+        bool operator==(const traversal_iterator& other) const noexcept
         {
+            return m_current == other.m_current;
         }
-    };
 
-    private_node* m_root;
+        /**
+         * @brief Returns a handle to the node the iterator points to.
+         */
+        [[nodiscard]] node get_node() const noexcept
+        {
+            return m_current;
+        }
+    };
 
-    // - handles null node
-    // - sets the pointers to nullptr
-    void delete_from_node(private_node* pnode)
+    /**
+     * @brief Forward iterator over the values of a subtree in breadth-first (level) order.
+     *
+     * Unlike the depth-first iterators it keeps the pending nodes of the next levels in a queue.
+     */
+    template <bool Const>
+    class level_order_iterator
     {
-        if (pnode == nullptr)
-            return;
-        const bool is_root = (pnode->m_parent == nullptr);
-        const bool is_left_child = !is_root && (pnode == pnode->m_parent->m_left_child);
-        const bool is_right_sibling = !is_root && !is_left_child;
-
-        if (is_left_child)
-            // set new left child
-            pnode->m_parent->m_left_child = pnode->m_right_sibling;
+    private:
+        std::queue<private_node*> m_pending;
+        friend class general_tree;
 
-        if (is_right_sibling)
+        level_order_iterator(private_node* subtree_root)
         {
-            private_node* aux = pnode->m_parent->m_left_child;
-            while (aux->m_right_sibling != pnode)
-                aux = aux->m_right_sibling;
-            aux->m_right_sibling = pnode->m_right_sibling;
+            if (subtree_root != nullptr)
+                m_pending.push(subtree_root);
         }
 
-        // Breadth First Algorithm
-        // Save the children in the queue and delete the parent
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const || !mutable_values, const T*, T*>;
+        using reference = std::conditional_t<Const || !mutable_values, const T&, T&>;
 
-        std::queue<private_node*> queue;
-        queue.push(pnode);
+        level_order_iterator() = default;
 
-        private_node* current = nullptr;
-        while (!queue.empty())
+        template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        level_order_iterator(const level_order_iterator<OtherConst>& other) : m_pending(other.m_pending)
         {
-            current = queue.front();
-            queue.pop();
+        }
 
-            for (private_node* child = current->m_left_child; child != nullptr; child = child->m_right_sibling)
-                queue.push(child);
+        reference operator*() const noexcept
+        {
+            return m_pending.front()->m_data;
+        }
 
-            delete current;
+        pointer operator->() const noexcept
+        {
+            return &m_pending.front()->m_data;
         }
-    }
 
-    void deep_copy(node n)
-    {
-        // Breadth First Algorithm
-        // Copy children of each node
-        if (n.m_node == nullptr)
-            return;
+        level_order_iterator& operator++()
+        {
+            for (private_node* child = m_pending.front()->m_left_child; child != nullptr;
+                 child = child->m_right_sibling)
+                m_pending.push(child);
+            m_pending.pop();
+            return *this;
+        }
 
-        private_node* copy_root = new private_node(n.m_node->m_data);
-        m_root = copy_root;
+        level_order_iterator operator++(int)
+        {
+            level_order_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
 
-        // keeps track of nodes whose children still need to be copied
-        std::queue<std::pair<private_node*, private_node*>> org_copy_relation_queue;
-        org_copy_relation_queue.push({n.m_node, copy_root});
+        bool operator==(const level_order_iterator& other) const noexcept
+        {
+            if (m_pending.empty() || other.m_pending.empty())
+                return m_pending.empty() == other.m_pending.empty();
+            return m_pending.front() == other.m_pending.front();
+        }
 
-        while (!org_copy_relation_queue.empty())
+        /**
+         * @brief Returns a handle to the node the iterator points to.
+         */
+        [[nodiscard]] node get_node() const noexcept
         {
-            private_node* original_node = org_copy_relation_queue.front().first;
-            private_node* copied_node = org_copy_relation_queue.front().second;
-            org_copy_relation_queue.pop();
+            return m_pending.empty() ? nullptr : m_pending.front();
+        }
+    };
 
-            private_node* child_original = original_node->m_left_child;
-            private_node* prev_copied_child = nullptr;
+    using preorder_iterator = traversal_iterator<preorder_traversal, false>;
+    using const_preorder_iterator = traversal_iterator<preorder_traversal, true>;
+    using postorder_iterator = traversal_iterator<postorder_traversal, false>;
+    using const_postorder_iterator = traversal_iterator<postorder_traversal, true>;
+    using bfs_iterator = level_order_iterator<false>;
+    using const_bfs_iterator = level_order_iterator<true>;
 
-            // children copy algorithm
-            while (child_original != nullptr)
-            {
-                private_node* child_copy = new private_node(child_original->m_data);
+    /**
+     * @brief Pre-order range over the nodes of a subtree.
+     */
+    class subtree_range
+    {
+    private:
+        private_node* m_subtree_root;
 
-                // if it is the first copied child, it goes as left child
-                if (prev_copied_child == nullptr)
-                    copied_node->m_left_child = child_copy;
-                else
-                    prev_copied_child->m_right_sibling = child_copy;
+    public:
+        subtree_range(private_node* subtree_root) noexcept : m_subtree_root(subtree_root) {}
 
-                org_copy_relation_queue.push({child_original, child_copy});
+        [[nodiscard]] preorder_iterator begin() const noexcept
+        {
+            return preorder_iterator(m_subtree_root);
+        }
 
-                prev_copied_child = child_copy;
-                child_original = child_original->m_right_sibling;
-            }
+        [[nodiscard]] preorder_iterator end() const noexcept
+        {
+            return preorder_iterator();
         }
-    }
+    };
 
-public:
     /**
      * @brief Public node interface
      */
@@ -119,6 +1715,7 @@ public:
     private:
         private_node* m_node;
         friend class general_tree;
+        friend class ancestry_index<general_tree>;
 
     public:
         node(private_node* node = nullptr) noexcept : m_node(node) {}
@@ -137,6 +1734,15 @@ public:
             return m_node->m_left_child;
         }
 
+        /**
+         * @brief Retrieves the last child of the current node.
+         * @return The last child node, or a null node if the current node has no children.
+         */
+        [[nodiscard]] node last_child() const noexcept
+        {
+            return m_node->m_last_child;
+        }
+
         /**
          * @brief Retrieves the parent of the current node.
          * @return The parent node, or a null node if the current node has no parent.
@@ -155,6 +1761,19 @@ public:
             return m_node->m_right_sibling;
         }
 
+        /**
+         * @brief Retrieves the left sibling of the current node.
+         *
+         * O(1) with tree_feature::left_sibling_links, otherwise the siblings are scanned from the first child of the
+         * parent.
+         *
+         * @return The left sibling node, or a null node if the current node is a first child or the root.
+         */
+        [[nodiscard]] node left_sibling() const noexcept
+        {
+            return find_left_sibling(m_node);
+        }
+
         /**
          * @brief Accesses the data stored in the given node.
          * @return const T& Reference to the data stored in the node.
@@ -169,12 +1788,52 @@ public:
 
         /**
          * @brief Accesses the data stored in the given node.
-         * @return T& Reference to the data stored in the node.
+         * @return T& Reference to the data stored in the node, const with tree_feature::structural_hash or an
+         * augmentation policy, whose values are replaced through general_tree::update_data().
          * @throws std::invalid_argument If the given node is null.
          */
-        [[nodiscard]] T& data()
+        [[nodiscard]] std::conditional_t<mutable_values, T&, const T&> data()
+        {
+            return const_cast<T&>(static_cast<const node&>(*this).data());
+        }
+
+        /**
+         * @brief Returns the hash of the values and the shape of the subtree rooted at the current node, in O(1).
+         *
+         * Requires tree_feature::structural_hash. Equal subtrees have equal hashes, so different hashes prove that two
+         * subtrees differ, which narrows down the changed regions between two versions of a tree.
+         *
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t subtree_hash() const
+        {
+            static_assert(structural_hash, "subtree_hash() requires tree_feature::structural_hash");
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot get hash of null node");
+            return m_node->m_hash.m_value;
+        }
+
+        /**
+         * @brief Returns the aggregate of the subtree rooted at the current node, as defined by the augmentation
+         * policy of the tree.
+         *
+         * O(1) when the policy is eager. A lazy policy first recomputes the stale aggregates below the node in a single
+         * pass, so concurrent reads of a lazy tree need external synchronization.
+         *
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] const typename Augmentation::value_type& aggregate() const
         {
-            return const_cast<T&>(static_cast<const general_tree<T>::node&>(*this).data());
+            static_assert(augmented, "aggregate() requires an augmentation policy");
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot get aggregate of null node");
+
+            if constexpr (lazy_augmentation)
+            {
+                if (m_node->m_aggregate.m_dirty)
+                    clean_aggregates(m_node);
+            }
+            return m_node->m_aggregate.m_value;
         }
 
         /*
@@ -224,6 +1883,10 @@ public:
 
         /**
          * @brief Retrieves the child node at the specified index.
+         *
+         * With tree_feature::indexed_children the lookup is O(1) and only reads the tree, the index of the children
+         * is kept up to date by every structural change.
+         *
          * @param index The zero-based index of the child to retrieve.
          * @return The child node at the specified index, or a null node if the index is out of range.
          * @throws std::invalid_argument If the current node is null.
@@ -233,6 +1896,15 @@ public:
             if (m_node == nullptr)
                 throw std::invalid_argument("Cannot get child of null node");
 
+            if constexpr (indexed_children)
+            {
+                const children_index& children = m_node->m_children_index;
+                if (index >= children.m_count)
+                    return nullptr;
+
+                return children[index];
+            }
+
             node child = m_node->m_left_child;
 
             for (std::size_t i = 0; i < index; i++)
@@ -246,7 +1918,7 @@ public:
         }
 
         /**
-         * @brief Counts the number of children of the current node.
+         * @brief Counts the number of children of the current node, in O(1) with tree_feature::indexed_children.
          * @return The total number of children of the current node.
          * @throws std::invalid_argument If the current node is null.
          */
@@ -255,6 +1927,9 @@ public:
             if (m_node == nullptr)
                 throw std::invalid_argument("Cannot count children of null node");
 
+            if constexpr (indexed_children)
+                return m_node->m_children_index.m_count;
+
             std::size_t count = 0;
             for (const private_node* child = m_node->m_left_child; child != nullptr; child = child->m_right_sibling)
                 ++count;
@@ -263,7 +1938,7 @@ public:
         }
 
         /**
-         * @brief Computes the depth of the current node in the tree.
+         * @brief Computes the depth of the current node in the tree, in O(1) with tree_feature::cached_depth.
          * @throws std::invalid_argument if the node is null.
          * @return std::size_t The depth of the node.
          */
@@ -272,6 +1947,9 @@ public:
             if (m_node == nullptr)
                 throw std::invalid_argument("Cannot get depth of null node");
 
+            if constexpr (cached_depth)
+                return m_node->m_depth;
+
             private_node* aux = m_node;
             std::size_t depth = 0;
 
@@ -285,7 +1963,8 @@ public:
         }
 
         /**
-         * @brief Computes the total number of descendants of the current node.
+         * @brief Computes the total number of descendants of the current node, in O(1) with
+         * tree_feature::subtree_sizes.
          * @return The total number of descendants of the current node.
          * @throws std::invalid_argument If the current node is null.
          */
@@ -294,53 +1973,436 @@ public:
             if (m_node == nullptr)
                 throw std::invalid_argument("Cannot get height of null node");
 
+            if constexpr (subtree_sizes)
+                return m_node->m_subtree_size - 1;
+
             std::size_t count = 0;
-            std::queue<private_node*> q;
-            q.push(m_node);
+            for (private_node* current = next_preorder(m_node, m_node); current != nullptr;
+                 current = next_preorder(current, m_node))
+                ++count;
+
+            return count;
+        }
+
+        /**
+         * @brief Retrieves the node at the given pre-order position of the subtree rooted at the current node.
+         *
+         * Position 0 is the current node itself. With tree_feature::subtree_sizes whole subtrees are skipped, which
+         * makes the lookup O(depth * children), otherwise the subtree is walked in pre-order.
+         *
+         * @param position The zero-based pre-order position of the node to retrieve.
+         * @return The node at the given position, or a null node if the position is out of range.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] node descendant_at(std::size_t position) const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot get descendant of null node");
 
-            while (!q.empty())
+            if constexpr (subtree_sizes)
             {
-                private_node* current_node = q.front();
-                q.pop();
+                if (position >= m_node->m_subtree_size)
+                    return nullptr;
 
-                for (private_node* left_child = current_node->m_left_child; left_child != nullptr;
-                     left_child = left_child->m_right_sibling)
+                private_node* current = m_node;
+                while (position != 0)
                 {
-                    q.push(left_child);
-                    ++count;
+                    // skip the current node, then every child whose subtree ends before the position
+                    --position;
+                    current = current->m_left_child;
+                    while (position >= current->m_subtree_size)
+                    {
+                        position -= current->m_subtree_size;
+                        current = current->m_right_sibling;
+                    }
                 }
+
+                return current;
+            }
+            else
+            {
+                private_node* current = m_node;
+                for (; current != nullptr && position != 0; --position)
+                    current = next_preorder(current, m_node);
+                return current;
             }
+        }
 
-            return count;
+        /**
+         * @brief Returns a pre-order range over the current node and all of its descendants.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] subtree_range subtree() const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot traverse subtree of null node");
+            return m_node;
+        }
+    };
+
+    /**
+     * @brief Range over consecutive siblings, such as the children inserted by a single call.
+     */
+    class sibling_range
+    {
+    private:
+        private_node* m_first;
+        private_node* m_end;
+
+    public:
+        class iterator
+        {
+        private:
+            private_node* m_current = nullptr;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = node;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = node;
+
+            iterator() noexcept = default;
+            explicit iterator(private_node* current) noexcept : m_current(current) {}
+
+            reference operator*() const noexcept
+            {
+                return m_current;
+            }
+
+            iterator& operator++() noexcept
+            {
+                m_current = m_current->m_right_sibling;
+                return *this;
+            }
+
+            iterator operator++(int) noexcept
+            {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const iterator& other) const noexcept
+            {
+                return m_current == other.m_current;
+            }
+        };
+
+        sibling_range(private_node* first = nullptr, private_node* end = nullptr) noexcept
+            : m_first(first), m_end(end)
+        {
+        }
+
+        [[nodiscard]] iterator begin() const noexcept
+        {
+            return iterator(m_first);
+        }
+
+        [[nodiscard]] iterator end() const noexcept
+        {
+            return iterator(m_end);
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return m_first == m_end;
         }
     };
 
-    general_tree() noexcept : m_root(nullptr) {}
+    general_tree() noexcept(noexcept(Allocator())) : general_tree(Allocator()) {}
+
+    explicit general_tree(const Allocator& allocator) noexcept : m_pool(allocator), m_root(nullptr) {}
+
+    general_tree(general_tree&& rhs) noexcept
+        : m_pool(std::move(rhs.m_pool)), m_root(std::exchange(rhs.m_root, nullptr))
+    {
+    }
+
+    general_tree(const general_tree& other)
+        : general_tree(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.get_allocator()))
+    {
+        deep_copy(other.root());
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+    general_tree(U&& root_value, const Allocator& allocator = Allocator()) : general_tree(allocator)
+    {
+        m_root = m_pool.create(std::forward<U>(root_value));
+    }
+
+    ~general_tree()
+    {
+        clear();
+    }
+
+    /**
+     * @brief Parent index of the root in from_parent_array().
+     */
+    static constexpr std::size_t no_parent = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * @brief Builds a tree in O(n) from the values of its nodes and the index of the parent of each one.
+     *
+     * Storage for every node is obtained at once. The children of a node keep the order of their indices.
+     *
+     * @param values The value of every node.
+     * @param parents The index of the parent of every node in values, no_parent for the only root.
+     * @throws std::invalid_argument If the sizes differ, an index is out of range, there is not exactly one root or
+     * some node cannot be reached from the root.
+     */
+    [[nodiscard]] static general_tree from_parent_array(std::span<const T> values, std::span<const std::size_t> parents,
+                                                        const Allocator& allocator = Allocator())
+    {
+        if (values.size() != parents.size())
+            throw std::invalid_argument("Values and parents must have the same size");
+
+        general_tree tree(allocator);
+        if (values.empty())
+            return tree;
+
+        std::vector<private_node*> nodes;
+        nodes.reserve(values.size());
+        tree.m_pool.reserve(values.size());
+
+        // every node is owned by the nodes vector until the tree is known to be valid
+        auto discard = [&] {
+            for (private_node* pnode : nodes)
+                tree.m_pool.destroy(pnode);
+        };
+
+        try
+        {
+            for (const T& value : values)
+                nodes.push_back(tree.m_pool.create(value));
+        }
+        catch (...)
+        {
+            discard();
+            throw;
+        }
+
+        private_node* root = nullptr;
+        const char* error = nullptr;
+        try
+        {
+            for (std::size_t i = 0; i < nodes.size() && error == nullptr; i++)
+            {
+                if (parents[i] == no_parent)
+                {
+                    if (root != nullptr)
+                        error = "Parent array contains more than one root";
+                    root = nodes[i];
+                }
+                else if (parents[i] >= nodes.size())
+                    error = "Parent index out of range";
+                else
+                {
+                    reserve_children(nodes[parents[i]], 1, false);
+                    link_last_child(nodes[parents[i]], nodes[i]);
+                }
+            }
+        }
+        catch (...)
+        {
+            discard();
+            throw;
+        }
+
+        if (error == nullptr && root == nullptr)
+            error = "Parent array contains no root";
+
+        // nodes on a cycle of parents are not reachable from the root
+        if (error == nullptr)
+        {
+            std::size_t reachable = 0;
+            for (private_node* current = root; current != nullptr; current = next_preorder(current, root))
+                ++reachable;
+            if (reachable != nodes.size())
+                error = "Parent array contains a cycle";
+        }
+
+        if (error != nullptr)
+        {
+            discard();
+            throw std::invalid_argument(error);
+        }
+
+        tree.m_root = root;
+        rebuild_bookkeeping(root);
+        return tree;
+    }
+
+    /**
+     * @brief Builds a tree in O(n) from the depth and value of every node in pre-order.
+     *
+     * The first element is the root, at depth 0, and every other one is at most one level deeper than the previous
+     * one. Storage for every node is obtained at once when the size of the range is known. The values of elements
+     * the range yields by value are moved into the nodes, the others are copied.
+     *
+     * @param nodes A range of (depth, value) pairs, such as std::pair<std::size_t, T>.
+     * @throws std::invalid_argument If a depth is negative or breaks the rules above.
+     */
+    template <std::ranges::input_range Range>
+    [[nodiscard]] static general_tree from_preorder_depths(Range&& nodes, const Allocator& allocator = Allocator())
+    {
+        general_tree tree(allocator);
+        if constexpr (std::ranges::sized_range<Range>)
+            tree.m_pool.reserve(static_cast<std::size_t>(std::ranges::size(nodes)));
+
+        private_node* current = nullptr;
+        std::size_t current_depth = 0;
+
+        for (auto&& element : nodes)
+        {
+            auto& [signed_depth, value] = element;
+            // the values of elements yielded by value are moved into the nodes
+            auto&& node_value = [&value]() -> decltype(auto) {
+                if constexpr (std::is_rvalue_reference_v<decltype(element)>)
+                    return std::move(value);
+                else
+                    return (value);
+            }();
+
+            if constexpr (std::is_signed_v<std::remove_cvref_t<decltype(signed_depth)>>)
+            {
+                if (signed_depth < 0)
+                    throw std::invalid_argument("Depth must not be negative");
+            }
+            const auto depth = static_cast<std::size_t>(signed_depth);
+
+            if (current == nullptr)
+            {
+                if (depth != 0)
+                    throw std::invalid_argument("The first node must be the root, at depth 0");
+
+                tree.m_root = current = tree.m_pool.create(std::forward<decltype(node_value)>(node_value));
+                continue;
+            }
+
+            if (depth == 0 || depth > current_depth + 1)
+                throw std::invalid_argument("Depth must be between 1 and one more than the previous depth");
+
+            // climb to the parent of the new node, the rest of the walk only descends through the new nodes
+            for (; current_depth >= depth; --current_depth)
+                current = current->m_parent;
+
+            reserve_children(current, 1, false);
+            private_node* child = tree.m_pool.create(std::forward<decltype(node_value)>(node_value));
+            link_last_child(current, child);
+            current = child;
+            current_depth = depth;
+        }
+
+        if (tree.m_root != nullptr)
+            rebuild_bookkeeping(tree.m_root);
+        return tree;
+    }
+
+    general_tree& operator=(const general_tree& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            if constexpr (std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value)
+                m_pool.reset(other.get_allocator());
+            deep_copy(other.root());
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Replaces the contents of the tree with the nodes of rhs, leaving rhs empty.
+     *
+     * The nodes are transferred without touching the stored values unless the allocator does not propagate and
+     * compares different, in which case every value is moved into storage of this tree.
+     */
+    general_tree& operator=(general_tree&& rhs) noexcept(
+        std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Allocator>::is_always_equal::value
+    )
+    {
+        if (this == &rhs)
+            return *this;
+
+        clear();
+
+        if constexpr (!std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value &&
+                      !std::allocator_traits<Allocator>::is_always_equal::value)
+        {
+            if (get_allocator() != rhs.get_allocator())
+            {
+                deep_copy(rhs.root(), [](T& value) -> T&& { return std::move(value); });
+                rhs.clear();
+                return *this;
+            }
+        }
+
+        m_pool = std::move(rhs.m_pool);
+        m_root = std::exchange(rhs.m_root, nullptr);
+        return *this;
+    }
+
+    /**
+     * @brief Exchanges the nodes of both trees. Node handles remain valid and refer to the other tree afterwards.
+     */
+    void swap(general_tree& other) noexcept
+    {
+        m_pool.swap(other.m_pool);
+        std::swap(m_root, other.m_root);
+    }
 
-    general_tree(general_tree<T>&& rhs) noexcept : m_root(std::exchange(rhs.m_root, nullptr)) {}
+    friend void swap(general_tree& lhs, general_tree& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
 
-    general_tree(const general_tree<T>& other) : general_tree<T>()
+    /**
+     * @brief Returns a copy of the allocator used to obtain node storage.
+     */
+    [[nodiscard]] allocator_type get_allocator() const noexcept
     {
-        deep_copy(other.root());
+        return m_pool.get_allocator();
     }
 
-    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
-    general_tree(U&& root_value) : general_tree()
+    /**
+     * @brief Returns the counters of the node storage of the tree, in O(1).
+     *
+     * Requires tree_feature::allocation_stats, which updates the counters at every node created or destroyed and at
+     * every page obtained from or returned to the allocator.
+     */
+    [[nodiscard]] tree_memory_stats memory_stats() const noexcept
     {
-        m_root = new private_node(std::forward<U>(root_value));
+        static_assert(allocation_stats, "memory_stats() requires tree_feature::allocation_stats");
+        return m_pool.stats();
     }
 
-    general_tree& operator=(const general_tree<T>& other)
+    /**
+     * @brief Returns the bytes held by the nodes of the subtree rooted at the given node.
+     *
+     * Covers the storage of the nodes and, with tree_feature::indexed_children, the heap memory of their children
+     * indexes. Memory owned by the values themselves is not included. O(1) with tree_feature::subtree_sizes and
+     * without tree_feature::indexed_children, otherwise O(size of the subtree).
+     *
+     * @throws std::invalid_argument If the node is null.
+     */
+    [[nodiscard]] std::size_t memory_usage(node n) const
     {
-        if (this != &other)
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot get memory usage of null node");
+
+        if constexpr (indexed_children)
         {
-            clear();
-            deep_copy(other.root());
+            std::size_t bytes = 0;
+            for (private_node* current = n.m_node; current != nullptr; current = next_preorder(current, n.m_node))
+                bytes += sizeof(private_node) + current->m_children_index.m_children.capacity() * sizeof(private_node*);
+            return bytes;
         }
-        return *this;
+        else
+            return (n.descendants_count() + 1) * sizeof(private_node);
     }
 
-    bool operator==(const general_tree<T>& other) const
+    bool operator==(const general_tree& other) const
     {
         if (m_root == other.m_root)
             return true;
@@ -348,41 +2410,54 @@ public:
         if (m_root == nullptr || other.m_root == nullptr)
             return false;
 
-        if (m_root->m_data != other.m_root->m_data)
-            return false;
-
-        // Breadth First Algorithm
-        // Compare the children of the equal nodes
+        // Pre-order walk over both trees in lockstep
+        // Both walks climb through the parent links at the same time, so the shapes are compared on the way
 
-        std::queue<std::pair<private_node*, private_node*>> equal_nodes;
-        equal_nodes.push({m_root, other.m_root});
+        private_node* tree1_node = m_root;
+        private_node* tree2_node = other.m_root;
 
-        while (!equal_nodes.empty())
+        while (true)
         {
-            private_node* tree1_node = equal_nodes.front().first;
-            private_node* tree2_node = equal_nodes.front().second;
-            equal_nodes.pop();
-
-            // compare every child of both nodes
-            private_node* tree1_node_current_child = tree1_node->m_left_child;
-            private_node* tree2_node_current_child = tree2_node->m_left_child;
-            while (tree1_node_current_child != nullptr && tree2_node_current_child != nullptr)
+            // different hashes prove that the subtrees differ, equal hashes still have to be compared
+            if constexpr (structural_hash)
             {
-                if (tree1_node_current_child->m_data != tree2_node_current_child->m_data)
+                if (tree1_node->m_hash.m_value != tree2_node->m_hash.m_value)
                     return false;
+            }
+
+            if (tree1_node->m_data != tree2_node->m_data)
+                return false;
+
+            // a node contains children and the other does not
+            if ((tree1_node->m_left_child == nullptr) != (tree2_node->m_left_child == nullptr))
+                return false;
+
+            if (tree1_node->m_left_child != nullptr)
+            {
+                tree1_node = tree1_node->m_left_child;
+                tree2_node = tree2_node->m_left_child;
+                continue;
+            }
 
-                equal_nodes.push({tree1_node_current_child, tree2_node_current_child});
+            while (tree1_node != m_root && tree1_node->m_right_sibling == nullptr)
+            {
+                // a node contains more children than the other
+                if (tree2_node->m_right_sibling != nullptr)
+                    return false;
 
-                tree2_node_current_child = tree2_node_current_child->m_right_sibling;
-                tree1_node_current_child = tree1_node_current_child->m_right_sibling;
+                tree1_node = tree1_node->m_parent;
+                tree2_node = tree2_node->m_parent;
             }
 
-            // a node contains more children than the other
-            if (tree1_node_current_child != nullptr || tree2_node_current_child != nullptr)
+            if (tree1_node == m_root)
+                return true;
+
+            if (tree2_node->m_right_sibling == nullptr)
                 return false;
-        }
 
-        return true;
+            tree1_node = tree1_node->m_right_sibling;
+            tree2_node = tree2_node->m_right_sibling;
+        }
     }
 
     /**
@@ -398,7 +2473,7 @@ public:
     {
         if (m_root != nullptr)
             throw std::runtime_error("Root already exists");
-        m_root = new private_node(std::forward<Args>(args)...);
+        m_root = m_pool.create(std::forward<Args>(args)...);
         return m_root;
     }
 
@@ -428,11 +2503,10 @@ public:
         if (destiny.m_node == nullptr)
             throw std::invalid_argument("Cannot insert left child to null node");
 
-        private_node* new_node = new private_node(std::forward<Args>(args)...);
-        new_node->m_right_sibling = destiny.m_node->m_left_child;
-        new_node->m_parent = destiny.m_node;
-
-        destiny.m_node->m_left_child = new_node;
+        reserve_children(destiny.m_node, 1, true);
+        private_node* new_node = m_pool.create(std::forward<Args>(args)...);
+        link_left_child(destiny.m_node, new_node);
+        subtree_attached(new_node);
         return new_node;
     }
 
@@ -457,26 +2531,148 @@ public:
      * @throws std::invalid_argument If the destination node is null or if attempting to insert the tree as a child of
      * its own root.
      */
-    node insert_left_child(node destiny, general_tree<T>& tree)
+    node insert_left_child(node destiny, general_tree& tree)
     {
         if (!destiny.m_node)
             throw std::invalid_argument("Cannot insert left child to null node");
 
-        if (destiny.m_node == tree.m_root)
+        if (destiny.m_node == tree.m_root || &tree == this)
+            throw std::invalid_argument("Cannot insert a tree as its own child");
+
+        if (tree.m_root)
+        {
+            reserve_children(destiny.m_node, 1, true);
+            private_node* subtree = adopt(tree);
+            link_left_child(destiny.m_node, subtree);
+            subtree_attached(subtree);
+            return subtree;
+        }
+
+        return node(nullptr);
+    }
+
+    /**
+     * @brief Creates and emplaces a new last child node for the given destination node, in O(1).
+     * @tparam Args Variadic template parameters for the new node constructor.
+     * @param destiny The node to which the new last child will be attached.
+     * @param args Arguments to forward to the new node's constructor.
+     * @return node A handle to the newly created last child node.
+     * @throws std::invalid_argument If the destination node is null.
+     */
+    template <typename... Args>
+    node emplace_last_child(node destiny, Args&&... args)
+    {
+        if (destiny.m_node == nullptr)
+            throw std::invalid_argument("Cannot insert last child to null node");
+
+        reserve_children(destiny.m_node, 1, false);
+        private_node* new_node = m_pool.create(std::forward<Args>(args)...);
+        link_last_child(destiny.m_node, new_node);
+        subtree_attached(new_node);
+        return new_node;
+    }
+
+    /**
+     * @brief Inserts a new last child node for the given destination node, with the provided value.
+     * @param destiny The node to which the last child will be inserted.
+     * @param new_node_value The value to store in the newly created last child node.
+     * @return node A handle to the newly created last child node.
+     * @throws std::invalid_argument If the destination node is null.
+     */
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+    node insert_last_child(node destiny, U&& new_node_value)
+    {
+        return emplace_last_child(destiny, std::forward<U>(new_node_value));
+    }
+
+    /**
+     * @brief Inserts an entire subtree as the last child of the given destination node.
+     * @param destiny The node to which the tree will be inserted as the last child.
+     * @param tree The tree to insert as the last child. After insertion, this tree will be empty.
+     * @return node A handle to the newly inserted last child node, or a null node if the tree is empty.
+     * @throws std::invalid_argument If the destination node is null or if attempting to insert the tree as a child of
+     * its own root.
+     */
+    node insert_last_child(node destiny, general_tree& tree)
+    {
+        if (!destiny.m_node)
+            throw std::invalid_argument("Cannot insert last child to null node");
+
+        if (destiny.m_node == tree.m_root || &tree == this)
             throw std::invalid_argument("Cannot insert a tree as its own child");
 
         if (tree.m_root)
         {
-            tree.m_root->m_parent = destiny.m_node;
-            tree.m_root->m_right_sibling = destiny.m_node->m_left_child;
-            destiny.m_node->m_left_child = tree.m_root;
-            tree.m_root = nullptr;
-            return destiny.m_node->m_left_child;
+            reserve_children(destiny.m_node, 1, false);
+            private_node* subtree = adopt(tree);
+            link_last_child(destiny.m_node, subtree);
+            subtree_attached(subtree);
+            return subtree;
         }
 
         return node(nullptr);
     }
 
+    /**
+     * @brief Creates a new child before the existing children of the given node for every element of a range.
+     *
+     * The new children keep the order of the range. Storage for all of them is obtained at once when the size of the
+     * range is known, and the bookkeeping of the ancestors is refreshed once for the whole batch.
+     *
+     * @param destiny The node to which the children will be attached.
+     * @param values The values of the new children, forwarded to their constructors.
+     * @return sibling_range A range over the handles of the new children.
+     * @throws std::invalid_argument If the destination node is null.
+     */
+    template <std::ranges::input_range Range>
+    sibling_range emplace_left_children(node destiny, Range&& values)
+    {
+        if (destiny.m_node == nullptr)
+            throw std::invalid_argument("Cannot insert children to null node");
+
+        return emplace_children(destiny.m_node, std::forward<Range>(values), true);
+    }
+
+    /**
+     * @brief Creates a new child after the existing children of the given node for every element of a range.
+     *
+     * The new children keep the order of the range. Storage for all of them is obtained at once when the size of the
+     * range is known, and the bookkeeping of the ancestors is refreshed once for the whole batch.
+     *
+     * @param destiny The node to which the children will be attached.
+     * @param values The values of the new children, forwarded to their constructors.
+     * @return sibling_range A range over the handles of the new children.
+     * @throws std::invalid_argument If the destination node is null.
+     */
+    template <std::ranges::input_range Range>
+    sibling_range emplace_last_children(node destiny, Range&& values)
+    {
+        if (destiny.m_node == nullptr)
+            throw std::invalid_argument("Cannot insert children to null node");
+
+        return emplace_children(destiny.m_node, std::forward<Range>(values), false);
+    }
+
+    /**
+     * @brief Inserts copies of the values in [first, last) before the existing children of the given node.
+     * @see emplace_left_children
+     */
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    sibling_range insert_left_children(node destiny, InputIt first, Sentinel last)
+    {
+        return emplace_left_children(destiny, std::ranges::subrange(std::move(first), std::move(last)));
+    }
+
+    /**
+     * @brief Inserts copies of the values in [first, last) after the existing children of the given node.
+     * @see emplace_last_children
+     */
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    sibling_range insert_last_children(node destiny, InputIt first, Sentinel last)
+    {
+        return emplace_last_children(destiny, std::ranges::subrange(std::move(first), std::move(last)));
+    }
+
     /**
      * @brief Inserts an entire subtree as the right sibling of the given destination node.
      * @param destiny The node to which the tree will be inserted as a right sibling.
@@ -485,7 +2681,7 @@ public:
      * @throws std::invalid_argument If the destination node is null, is the root (cannot have siblings),
      *                               or if attempting to insert the tree as its own sibling.
      */
-    node insert_right_sibling(node destiny, general_tree<T>& tree)
+    node insert_right_sibling(node destiny, general_tree& tree)
     {
         if (destiny.m_node == nullptr)
             throw std::invalid_argument("Cannot insert right sibling to null node");
@@ -493,16 +2689,16 @@ public:
         if (destiny.m_node->m_parent == nullptr)
             throw std::invalid_argument("Cannot insert right sibling to root");
 
-        if (destiny.m_node == tree.m_root)
+        if (destiny.m_node == tree.m_root || &tree == this)
             throw std::invalid_argument("Cannot insert a tree as its own sibling");
 
         if (tree.m_root)
         {
-            tree.m_root->m_parent = destiny.m_node->m_parent;
-            tree.m_root->m_right_sibling = destiny.m_node->m_right_sibling;
-            destiny.m_node->m_right_sibling = tree.m_root;
-            tree.m_root = nullptr;
-            return destiny.m_node->m_right_sibling;
+            reserve_children(destiny.m_node->m_parent, 1, false);
+            private_node* subtree = adopt(tree);
+            link_right_sibling(destiny.m_node, subtree);
+            subtree_attached(subtree);
+            return subtree;
         }
 
         return node(nullptr);
@@ -525,10 +2721,10 @@ public:
         if (destiny.m_node->m_parent == nullptr)
             throw std::invalid_argument("Cannot insert right sibling to root");
 
-        private_node* new_node = new private_node(std::forward<Args>(args)...);
-        new_node->m_parent = destiny.m_node->m_parent;
-        new_node->m_right_sibling = destiny.m_node->m_right_sibling;
-        destiny.m_node->m_right_sibling = new_node;
+        reserve_children(destiny.m_node->m_parent, 1, false);
+        private_node* new_node = m_pool.create(std::forward<Args>(args)...);
+        link_right_sibling(destiny.m_node, new_node);
+        subtree_attached(new_node);
         return new_node;
     }
 
@@ -553,6 +2749,357 @@ public:
         return m_root;
     }
 
+    /**
+     * @brief Returns an iterator to the first value of the tree in pre-order (the root).
+     */
+    [[nodiscard]] preorder_iterator preorder_begin() noexcept
+    {
+        return preorder_iterator(m_root);
+    }
+
+    [[nodiscard]] const_preorder_iterator preorder_begin() const noexcept
+    {
+        return const_preorder_iterator(m_root);
+    }
+
+    /**
+     * @brief Returns the past-the-end pre-order iterator.
+     */
+    [[nodiscard]] preorder_iterator preorder_end() noexcept
+    {
+        return preorder_iterator();
+    }
+
+    [[nodiscard]] const_preorder_iterator preorder_end() const noexcept
+    {
+        return const_preorder_iterator();
+    }
+
+    /**
+     * @brief Returns an iterator to the first value of the tree in post-order (its leftmost leaf).
+     */
+    [[nodiscard]] postorder_iterator postorder_begin() noexcept
+    {
+        return postorder_iterator(m_root);
+    }
+
+    [[nodiscard]] const_postorder_iterator postorder_begin() const noexcept
+    {
+        return const_postorder_iterator(m_root);
+    }
+
+    /**
+     * @brief Returns the past-the-end post-order iterator.
+     */
+    [[nodiscard]] postorder_iterator postorder_end() noexcept
+    {
+        return postorder_iterator();
+    }
+
+    [[nodiscard]] const_postorder_iterator postorder_end() const noexcept
+    {
+        return const_postorder_iterator();
+    }
+
+    /**
+     * @brief Returns an iterator to the first value of the tree in level order (the root).
+     */
+    [[nodiscard]] bfs_iterator bfs_begin()
+    {
+        return bfs_iterator(m_root);
+    }
+
+    [[nodiscard]] const_bfs_iterator bfs_begin() const
+    {
+        return const_bfs_iterator(m_root);
+    }
+
+    /**
+     * @brief Returns the past-the-end level order iterator.
+     */
+    [[nodiscard]] bfs_iterator bfs_end()
+    {
+        return bfs_iterator();
+    }
+
+    [[nodiscard]] const_bfs_iterator bfs_end() const
+    {
+        return const_bfs_iterator();
+    }
+
+    /**
+     * @brief Calls f with a handle to every node of the subtree rooted at n, in the order given by Order.
+     *
+     * The walk follows the links of the nodes directly, prefetching the node visited next, and the callback is a
+     * template parameter, so small callbacks are inlined into the loop. The level order keeps one vector of the nodes
+     * of the current level that have children, instead of queueing every node.
+     *
+     * @param f Called with a node; the visit stops as soon as it returns a value converting to false.
+     * @return bool false if f stopped the visit, true otherwise.
+     * @throws std::invalid_argument If n is null.
+     */
+    template <visit_order Order, typename F>
+    bool visit(node n, F&& f) const
+    {
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot visit null node");
+
+        private_node* subtree_root = n.m_node;
+
+        if constexpr (Order == visit_order::preorder)
+        {
+            for (private_node* current = subtree_root; current != nullptr;)
+            {
+                prefetch(current->m_left_child != nullptr ? current->m_left_child : current->m_right_sibling);
+                if (!visit_node(f, current))
+                    return false;
+                current = next_preorder(current, subtree_root);
+            }
+        }
+        else if constexpr (Order == visit_order::postorder)
+        {
+            for (private_node* current = leftmost_leaf(subtree_root); current != nullptr;)
+            {
+                prefetch(current->m_right_sibling != nullptr ? current->m_right_sibling : current->m_parent);
+                if (!visit_node(f, current))
+                    return false;
+                current = next_postorder(current, subtree_root);
+            }
+        }
+        else
+        {
+            if (!visit_node(f, subtree_root))
+                return false;
+
+            std::vector<private_node*> level;
+            std::vector<private_node*> next_level;
+            if (subtree_root->m_left_child != nullptr)
+                level.push_back(subtree_root);
+
+            while (!level.empty())
+            {
+                for (private_node* parent : level)
+                {
+                    for (private_node* child = parent->m_left_child; child != nullptr; child = child->m_right_sibling)
+                    {
+                        prefetch(child->m_right_sibling);
+                        if (!visit_node(f, child))
+                            return false;
+                        if (child->m_left_child != nullptr)
+                            next_level.push_back(child);
+                    }
+                }
+                level.swap(next_level);
+                next_level.clear();
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Walks the subtree rooted at n depth-first, calling enter with a handle to every node before its
+     * descendants and leave after them.
+     *
+     * @param enter Called with a node on the way down; the visit stops as soon as it returns a value converting to
+     * false.
+     * @param leave Called with a node on the way up; the visit stops as soon as it returns a value converting to
+     * false.
+     * @return bool false if a callback stopped the visit, true otherwise.
+     * @throws std::invalid_argument If n is null.
+     */
+    template <typename Enter, typename Leave>
+    bool visit(node n, Enter&& enter, Leave&& leave) const
+    {
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot visit null node");
+
+        private_node* subtree_root = n.m_node;
+        private_node* current = subtree_root;
+        if (!visit_node(enter, current))
+            return false;
+
+        while (true)
+        {
+            if (current->m_left_child != nullptr)
+            {
+                current = current->m_left_child;
+                prefetch(current->m_left_child);
+                if (!visit_node(enter, current))
+                    return false;
+                continue;
+            }
+
+            // climb until a right sibling is left, leaving every finished node
+            while (true)
+            {
+                if (!visit_node(leave, current))
+                    return false;
+                if (current == subtree_root)
+                    return true;
+                if (current->m_right_sibling != nullptr)
+                    break;
+                current = current->m_parent;
+            }
+
+            current = current->m_right_sibling;
+            prefetch(current->m_left_child);
+            if (!visit_node(enter, current))
+                return false;
+        }
+    }
+
+    /**
+     * @brief Copies the tree using every worker of the given executor, such as a work_stealing_pool.
+     *
+     * Whole subtrees are handed to idle workers while the copy is in progress, and each worker allocates from its
+     * own node storage, which is merged into the copy at the end. The result is identical to the copy constructor,
+     * sibling order included. Copies of the allocator must compare equal and be usable from several threads.
+     *
+     * @param executor Provides concurrency() and run(f), calling f with a worker offering index(), spawn(task) and
+     * hungry().
+     * @return A copy of the tree.
+     */
+    template <typename Executor>
+    [[nodiscard]] general_tree parallel_copy(Executor& executor) const
+    {
+        general_tree copy(std::allocator_traits<Allocator>::select_on_container_copy_construction(get_allocator()));
+        if (m_root == nullptr)
+            return copy;
+
+        copy.m_root = copy.m_pool.create(m_root->m_data);
+        copy_bookkeeping(copy.m_root, m_root);
+
+        std::vector<node_pool> pools;
+        pools.reserve(executor.concurrency());
+        for (std::size_t i = 0; i < executor.concurrency(); i++)
+            pools.emplace_back(copy.get_allocator());
+
+        // the nodes copied before a failure are linked, merging the pools lets the copy release them
+        // if merging itself fails the nodes are abandoned, since their storage goes away with the pools
+        auto merge_pools = [&] {
+            try
+            {
+                for (node_pool& pool : pools)
+                    copy.m_pool.merge(pool);
+            }
+            catch (...)
+            {
+                copy.m_root = nullptr;
+                throw;
+            }
+        };
+
+        try
+        {
+            private_node* const copy_root = copy.m_root;
+            executor.run([this, &pools, copy_root](auto& worker) {
+                parallel_copy_subtree(pools, m_root, copy_root, worker);
+            });
+        }
+        catch (...)
+        {
+            merge_pools();
+            throw;
+        }
+
+        merge_pools();
+        return copy;
+    }
+
+    /**
+     * @brief Calls f with a handle to every node of the subtree rooted at n, using every worker of the given executor.
+     *
+     * Right siblings heading big enough subtrees (judged by their size with tree_feature::subtree_sizes, otherwise by
+     * having children) are handed to idle workers as a whole, and nodes are passed on in batches, so a single deep
+     * chain or a huge fan-out is still spread across the workers. f is called concurrently on distinct nodes, in no
+     * particular order, and must not change the structure of the tree.
+     *
+     * @param executor Provides run(f), calling f with a worker offering spawn(task) and hungry().
+     * @param f Called once with every node.
+     * @throws std::invalid_argument If n is null.
+     * @throws Rethrows the first exception thrown by f, once the tasks already started have finished.
+     */
+    template <typename Executor, typename F>
+    void parallel_for_each(node n, Executor& executor, F&& f) const
+    {
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot visit null node");
+
+        private_node* const subtree_root = n.m_node;
+        executor.run([subtree_root, &f](auto& worker) { parallel_for_each_subtree(subtree_root, f, worker); });
+    }
+
+    /**
+     * @brief Calls f with a handle to every node of the tree, using every worker of the given executor.
+     * @see parallel_for_each(node, Executor&, F&&)
+     */
+    template <typename Executor, typename F>
+    void parallel_for_each(Executor& executor, F&& f) const
+    {
+        if (m_root != nullptr)
+            parallel_for_each(node(m_root), executor, std::forward<F>(f));
+    }
+
+    /**
+     * @brief Folds the subtree rooted at n bottom-up, using every worker of the given executor.
+     *
+     * The result of a node is combine(...combine(combine(map(node), result of its first child), result of its second
+     * child)..., result of its last child), so combine needs to be neither commutative nor associative and the
+     * result does not depend on the scheduling. Nodes are mapped in parallel, in batches split between idle workers,
+     * and each node is folded as soon as its children are done. The subtree is first laid out in pre-order by a
+     * single O(n) walk.
+     *
+     * @param executor Provides run(f), calling f with a worker offering spawn(task) and hungry().
+     * @param map Called with every node, concurrently on distinct nodes, returning a default constructible result.
+     * @param combine Called with the result folded so far and the result of a child, returning the new result.
+     * @return The result of n.
+     * @throws std::invalid_argument If n is null.
+     * @throws Rethrows the first exception thrown by map or combine, once the tasks already started have finished.
+     */
+    template <typename Executor, typename Map, typename Combine>
+    auto parallel_reduce(node n, Executor& executor, Map&& map, Combine&& combine) const
+    {
+        using result_type = std::invoke_result_t<Map&, node>;
+        std::size_t size;
+        auto results = parallel_reduce_into<result_type>(n, executor, map, combine, false, size);
+        return std::move(results[0].m_value);
+    }
+
+    /**
+     * @brief Folds the subtree rooted at n bottom-up like parallel_reduce(n, executor, map, combine), keeping the
+     * result of every node.
+     *
+     * @param results Receives the result of every node of the subtree, in pre-order, the first being the result of n.
+     * The results of the children are copied into combine instead of moved, and the results are moved into the
+     * vector once the fold is done.
+     * @return The result of n.
+     */
+    template <typename Executor, typename Map, typename Combine, typename R>
+    R parallel_reduce(node n, Executor& executor, Map&& map, Combine&& combine, std::vector<R>& results) const
+    {
+        std::size_t size;
+        auto slots = parallel_reduce_into<R>(n, executor, map, combine, true, size);
+
+        results.clear();
+        results.reserve(size);
+        for (std::size_t i = 0; i < size; i++)
+            results.push_back(std::move(slots[i].m_value));
+        return results.front();
+    }
+
+    /**
+     * @brief Takes an immutable, contiguous pre-order snapshot of the tree. Defined in "frozen-tree.h".
+     * @throws std::length_error If the tree has more nodes than 32-bit indices can address.
+     */
+    [[nodiscard]] frozen_tree<T> freeze() const;
+
+    /**
+     * @brief Builds a read-only copy of the tree storing identical subtrees once. Defined in "compact-tree.h".
+     * @throws std::length_error If the tree has more nodes than 32-bit indices can address.
+     */
+    [[nodiscard]] compact_tree<T> compact_shared() const;
+
     /**
      * @brief Checks whether the tree is empty.
      */
@@ -562,12 +3109,19 @@ public:
     }
 
     /**
-     * @brief Clears all nodes from the tree.
+     * @brief Clears all nodes from the tree and returns their storage to the allocator.
      */
-    void clear()
+    void clear() noexcept
     {
-        delete_from_node(m_root);
+        // nodes that need no destruction are released page by page without visiting them
+        if constexpr (!std::is_trivially_destructible_v<private_node>)
+        {
+            if (m_root != nullptr)
+                destroy_subtree(m_root);
+        }
+
         m_root = nullptr;
+        m_pool.release();
     }
 
     void delete_right_sibling(node n)
@@ -578,7 +3132,7 @@ public:
         if (n.is_root())
             throw std::invalid_argument("Can not delete right sibling of root node");
 
-        delete_from_node(n.m_node->m_right_sibling);
+        delete_from_node(n.m_node->m_right_sibling, n.m_node);
     }
 
     void delete_left_child(node n)
@@ -586,6 +3140,45 @@ public:
         if (n.is_null())
             throw std::invalid_argument("Can not delete left child of null node");
 
-        delete_from_node(n.m_node->m_left_child);
+        delete_from_node(n.m_node->m_left_child, nullptr);
+    }
+
+    /**
+     * @brief Deletes the given node and all its descendants. Deleting the root clears the tree.
+     *
+     * Unlinking the node is O(1) with tree_feature::left_sibling_links, otherwise its left sibling is found by
+     * scanning the siblings from the first child of the parent.
+     *
+     * @throws std::invalid_argument If the node is null.
+     */
+    void delete_node(node n)
+    {
+        if (n.is_null())
+            throw std::invalid_argument("Can not delete null node");
+
+        if (n.is_root())
+            clear();
+        else
+            delete_from_node(n.m_node);
+    }
+
+    /**
+     * @brief Replaces the value stored in the given node, refreshing the bookkeeping that depends on values.
+     *
+     * This is the only way of modifying values with tree_feature::structural_hash or an augmentation policy, which
+     * recompute the hashes and aggregates from the node up to the root.
+     *
+     * @param n The node whose value is replaced.
+     * @param value The new value, assigned to the stored one.
+     * @throws std::invalid_argument If the node is null.
+     */
+    template <typename U>
+    void update_data(node n, U&& value)
+    {
+        if (n.m_node == nullptr)
+            throw std::invalid_argument("Cannot update data of null node");
+
+        n.m_node->m_data = std::forward<U>(value);
+        data_changed(n.m_node);
     }
 };
@@ -0,0 +1,526 @@
+#pragma once
+
+#include "frozen-tree.h"
+#include "general-tree.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * On-disk layout, in the byte order and representation of the machine that wrote it:
+ * - a 32-byte header: the 8 bytes "GTMAP\0\0\1", the uint32 0x01020304 to detect a foreign byte order, sizeof(T) and
+ *   alignof(T) as uint32, and the number of nodes as uint64
+ * - the parent of every node in pre-order, as uint32 (0xffffffff for the root)
+ * - the subtree size of every node in pre-order, as uint32
+ * - the values in pre-order, starting at the first offset aligned for T
+ *
+ * This is the layout of frozen_tree, so navigation works the same way.
+ */
+
+/**
+ * @brief Read-only view over a tree stored in a file, navigated in place through a memory mapping.
+ *
+ * Opening the view maps the file without reading it, so it is ready immediately whatever the size of the tree, and
+ * pages are loaded on first access and shared with every other process mapping the same file. Only the header and
+ * the size of the file are checked: the content is trusted.
+ */
+template <typename T>
+class mapped_tree_view
+{
+    static_assert(std::is_trivially_copyable_v<T>, "mapped_tree_view requires a trivially copyable type");
+
+public:
+    using index_type = std::uint32_t;
+
+    static constexpr index_type null_index = std::numeric_limits<index_type>::max();
+
+private:
+    struct header
+    {
+        char m_magic[8];
+        std::uint32_t m_byte_order;
+        std::uint32_t m_value_size;
+        std::uint32_t m_value_alignment;
+        std::uint32_t m_reserved;
+        std::uint64_t m_size;
+    };
+
+    static_assert(sizeof(header) == 32);
+
+    static constexpr char magic[8] = {'G', 'T', 'M', 'A', 'P', '\0', '\0', '\1'};
+    static constexpr std::uint32_t byte_order = 0x01020304;
+
+    static constexpr std::size_t values_offset(std::size_t size) noexcept
+    {
+        const std::size_t end = sizeof(header) + 2 * sizeof(index_type) * size;
+        return (end + alignof(T) - 1) / alignof(T) * alignof(T);
+    }
+
+    void* m_mapping = nullptr;
+    std::size_t m_mapping_size = 0;
+#ifdef _WIN32
+    HANDLE m_file_mapping = nullptr;
+#endif
+
+    std::size_t m_size = 0;
+    const index_type* m_parent = nullptr;
+    const index_type* m_subtree_size = nullptr;
+    const T* m_data = nullptr;
+
+public:
+    /**
+     * @brief Public node interface
+     */
+    class node
+    {
+    private:
+        const mapped_tree_view* m_tree;
+        index_type m_index;
+        friend class mapped_tree_view;
+
+        node(const mapped_tree_view* tree, index_type index) noexcept : m_tree(tree), m_index(index) {}
+
+        node make(index_type index) const noexcept
+        {
+            return node(index == null_index ? nullptr : m_tree, index);
+        }
+
+    public:
+        node() noexcept : m_tree(nullptr), m_index(null_index) {}
+
+        bool operator==(const node& other) const noexcept
+        {
+            return m_tree == other.m_tree && m_index == other.m_index;
+        }
+
+        /**
+         * @brief Position of the node in the pre-order layout, or null_index for a null node.
+         */
+        [[nodiscard]] index_type index() const noexcept
+        {
+            return m_index;
+        }
+
+        /**
+         * @brief Retrieves the left child of the current node.
+         * @return The left child node, or a null node if the current node has no left child.
+         */
+        [[nodiscard]] node left_child() const noexcept
+        {
+            return is_leaf() ? node() : make(m_index + 1);
+        }
+
+        /**
+         * @brief Retrieves the parent of the current node.
+         * @return The parent node, or a null node if the current node has no parent.
+         */
+        [[nodiscard]] node parent() const noexcept
+        {
+            return make(m_tree->m_parent[m_index]);
+        }
+
+        /**
+         * @brief Retrieves the right sibling of the current node.
+         * @return The right sibling node, or a null node if the current node has no right sibling.
+         */
+        [[nodiscard]] node right_sibling() const noexcept
+        {
+            return has_right_sibling() ? make(m_index + m_tree->m_subtree_size[m_index]) : node();
+        }
+
+        /**
+         * @brief Accesses the data stored in the given node.
+         * @return const T& Reference to the data stored in the node, inside the mapping.
+         * @throws std::invalid_argument If the given node is null.
+         */
+        [[nodiscard]] const T& data() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get data from null node");
+            return m_tree->m_data[m_index];
+        }
+
+        /**
+         * @brief Checks if the node is the root of the tree.
+         * @return true if the node is the root, false otherwise.
+         */
+        bool is_root() const noexcept
+        {
+            return m_index == 0;
+        }
+
+        /**
+         * @brief Checks if the node is a leaf in the tree.
+         * @return true if the node is a leaf, false otherwise.
+         */
+        bool is_leaf() const noexcept
+        {
+            return m_tree->m_subtree_size[m_index] == 1;
+        }
+
+        /**
+         * @brief Checks if the node has a right sibling.
+         * @return true if the node has a right sibling, false otherwise.
+         */
+        bool has_right_sibling() const noexcept
+        {
+            const index_type parent = m_tree->m_parent[m_index];
+            return parent != null_index &&
+                   m_index + m_tree->m_subtree_size[m_index] < parent + m_tree->m_subtree_size[parent];
+        }
+
+        /**
+         * @brief Checks if the node has a left child.
+         * @return true if the node has a left child, false otherwise.
+         */
+        bool has_left_child() const noexcept
+        {
+            return !is_leaf();
+        }
+
+        /**
+         * @brief Checks if the node is null.
+         * @return true if the node is null, false otherwise.
+         */
+        bool is_null() const noexcept
+        {
+            return m_tree == nullptr;
+        }
+
+        /**
+         * @brief Retrieves the child node at the specified index.
+         * @param index The zero-based index of the child to retrieve.
+         * @return The child node at the specified index, or a null node if the index is out of range.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] node child(std::size_t index) const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get child of null node");
+
+            node child = left_child();
+            for (std::size_t i = 0; i < index && !child.is_null(); i++)
+                child = child.right_sibling();
+
+            return child;
+        }
+
+        /**
+         * @brief Counts the number of children of the current node.
+         * @return The total number of children of the current node.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t children_count() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot count children of null node");
+
+            std::size_t count = 0;
+            const index_type end = m_index + m_tree->m_subtree_size[m_index];
+            for (index_type child = m_index + 1; child < end; child += m_tree->m_subtree_size[child])
+                ++count;
+
+            return count;
+        }
+
+        /**
+         * @brief Computes the depth of the current node in the tree.
+         * @throws std::invalid_argument if the node is null.
+         * @return std::size_t The depth of the node.
+         */
+        [[nodiscard]] std::size_t depth() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get depth of null node");
+
+            std::size_t depth = 0;
+            for (index_type aux = m_tree->m_parent[m_index]; aux != null_index; aux = m_tree->m_parent[aux])
+                ++depth;
+
+            return depth;
+        }
+
+        /**
+         * @brief Returns the total number of descendants of the current node in O(1).
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t descendants_count() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot get descendants of null node");
+            return m_tree->m_subtree_size[m_index] - 1;
+        }
+
+        /**
+         * @brief Returns the values of the current node and all of its descendants, in pre-order.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::span<const T> subtree() const
+        {
+            if (m_tree == nullptr)
+                throw std::invalid_argument("Cannot traverse subtree of null node");
+            return std::span<const T>(m_tree->m_data + m_index, m_tree->m_subtree_size[m_index]);
+        }
+    };
+
+    mapped_tree_view() = default;
+
+    /**
+     * @brief Maps the given file, written by write_mapped_tree().
+     * @throws std::runtime_error If the file cannot be mapped, or was not written for this type on this kind of
+     * machine.
+     */
+    explicit mapped_tree_view(const std::string& path)
+    {
+        map(path);
+
+        try
+        {
+            if (m_mapping_size < sizeof(header))
+                throw std::runtime_error("Not a mapped tree file");
+
+            header h;
+            std::memcpy(&h, m_mapping, sizeof(header));
+            if (std::memcmp(h.m_magic, magic, sizeof(magic)) != 0)
+                throw std::runtime_error("Not a mapped tree file");
+            if (h.m_byte_order != byte_order || h.m_value_size != sizeof(T) || h.m_value_alignment != alignof(T))
+                throw std::runtime_error("Mapped tree file written for another type or machine");
+            if (h.m_size >= null_index || m_mapping_size < values_offset(h.m_size) + h.m_size * sizeof(T))
+                throw std::runtime_error("Truncated mapped tree file");
+
+            const auto* bytes = static_cast<const std::byte*>(m_mapping);
+            m_size = static_cast<std::size_t>(h.m_size);
+            m_parent = reinterpret_cast<const index_type*>(bytes + sizeof(header));
+            m_subtree_size = m_parent + m_size;
+            m_data = reinterpret_cast<const T*>(bytes + values_offset(m_size));
+        }
+        catch (...)
+        {
+            unmap();
+            throw;
+        }
+    }
+
+    mapped_tree_view(mapped_tree_view&& rhs) noexcept
+    {
+        swap(rhs);
+    }
+
+    mapped_tree_view& operator=(mapped_tree_view&& rhs) noexcept
+    {
+        mapped_tree_view(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    mapped_tree_view(const mapped_tree_view&) = delete;
+    mapped_tree_view& operator=(const mapped_tree_view&) = delete;
+
+    ~mapped_tree_view()
+    {
+        unmap();
+    }
+
+    void swap(mapped_tree_view& other) noexcept
+    {
+        std::swap(m_mapping, other.m_mapping);
+        std::swap(m_mapping_size, other.m_mapping_size);
+#ifdef _WIN32
+        std::swap(m_file_mapping, other.m_file_mapping);
+#endif
+        std::swap(m_size, other.m_size);
+        std::swap(m_parent, other.m_parent);
+        std::swap(m_subtree_size, other.m_subtree_size);
+        std::swap(m_data, other.m_data);
+    }
+
+    /**
+     * @brief Returns the root node of the tree.
+     */
+    [[nodiscard]] node root() const noexcept
+    {
+        return empty() ? node() : node(this, 0);
+    }
+
+    /**
+     * @brief Checks whether the tree is empty.
+     */
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * @brief Returns the number of nodes of the tree.
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Returns the node stored at the given pre-order position.
+     * @throws std::out_of_range If the index is not smaller than size().
+     */
+    [[nodiscard]] node at(std::size_t index) const
+    {
+        if (index >= m_size)
+            throw std::out_of_range("Node index out of range");
+        return node(this, static_cast<index_type>(index));
+    }
+
+    /**
+     * @brief Returns every value of the tree, in pre-order.
+     */
+    [[nodiscard]] std::span<const T> values() const noexcept
+    {
+        return std::span<const T>(m_data, m_size);
+    }
+
+    /**
+     * @brief Writes a snapshot in the layout read by mapped_tree_view.
+     * @throws std::runtime_error If the stream fails.
+     */
+    static void write(const frozen_tree<T>& tree, std::ostream& out)
+    {
+        header h{};
+        std::memcpy(h.m_magic, magic, sizeof(magic));
+        h.m_byte_order = byte_order;
+        h.m_value_size = sizeof(T);
+        h.m_value_alignment = alignof(T);
+        h.m_size = tree.size();
+        out.write(reinterpret_cast<const char*>(&h), sizeof(header));
+
+        for (std::size_t i = 0; i < tree.size(); i++)
+        {
+            const index_type parent = tree.at(i).parent().index();
+            out.write(reinterpret_cast<const char*>(&parent), sizeof(index_type));
+        }
+
+        for (std::size_t i = 0; i < tree.size(); i++)
+        {
+            const auto size = static_cast<index_type>(tree.at(i).descendants_count() + 1);
+            out.write(reinterpret_cast<const char*>(&size), sizeof(index_type));
+        }
+
+        const std::size_t padding = values_offset(tree.size()) - sizeof(header) - 2 * sizeof(index_type) * tree.size();
+        const char zeros[alignof(T)] = {};
+        out.write(zeros, static_cast<std::streamsize>(padding));
+
+        for (const T& value : tree)
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+
+        if (!out)
+            throw std::runtime_error("Cannot write mapped tree");
+    }
+
+private:
+    void map(const std::string& path)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Cannot open " + path);
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Cannot read the size of " + path);
+        }
+
+        m_mapping_size = static_cast<std::size_t>(size.QuadPart);
+        if (m_mapping_size != 0)
+        {
+            m_file_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_file_mapping != nullptr)
+                m_mapping = MapViewOfFile(m_file_mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        CloseHandle(file);
+
+        if (m_mapping_size != 0 && m_mapping == nullptr)
+        {
+            unmap();
+            throw std::runtime_error("Cannot map " + path);
+        }
+#else
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if (file == -1)
+            throw std::runtime_error("Cannot open " + path);
+
+        struct stat status;
+        if (::fstat(file, &status) == -1)
+        {
+            ::close(file);
+            throw std::runtime_error("Cannot read the size of " + path);
+        }
+
+        m_mapping_size = static_cast<std::size_t>(status.st_size);
+        if (m_mapping_size != 0)
+        {
+            // the mapping keeps the file alive once the descriptor is closed
+            void* mapping = ::mmap(nullptr, m_mapping_size, PROT_READ, MAP_SHARED, file, 0);
+            if (mapping != MAP_FAILED)
+                m_mapping = mapping;
+        }
+        ::close(file);
+
+        if (m_mapping_size != 0 && m_mapping == nullptr)
+        {
+            m_mapping_size = 0;
+            throw std::runtime_error("Cannot map " + path);
+        }
+#endif
+    }
+
+    void unmap() noexcept
+    {
+#ifdef _WIN32
+        if (m_mapping != nullptr)
+            UnmapViewOfFile(m_mapping);
+        if (m_file_mapping != nullptr)
+            CloseHandle(m_file_mapping);
+        m_file_mapping = nullptr;
+#else
+        if (m_mapping != nullptr)
+            ::munmap(m_mapping, m_mapping_size);
+#endif
+        m_mapping = nullptr;
+        m_mapping_size = 0;
+        m_size = 0;
+        m_parent = nullptr;
+        m_subtree_size = nullptr;
+        m_data = nullptr;
+    }
+};
+
+/**
+ * @brief Writes the tree in the layout read by mapped_tree_view.
+ * @throws std::runtime_error If the stream fails.
+ * @throws std::length_error If the tree has more nodes than 32-bit indices can address.
+ */
+template <typename T, typename Allocator, tree_feature Features, typename Augmentation>
+void write_mapped_tree(const general_tree<T, Allocator, Features, Augmentation>& tree,
+                       std::ostream& out)
+{
+    mapped_tree_view<T>::write(tree.freeze(), out);
+}
@@ -0,0 +1,428 @@
+#pragma once
+
+#include "shared-release.h"
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Immutable general tree whose modifications return new versions sharing the untouched nodes.
+ *
+ * Nodes use the left child / right sibling representation and are shared through reference counting. A node is
+ * reachable from its parent through the chain of its left siblings, so a modification copies the modified node,
+ * its left siblings and, for every ancestor, the ancestor and its left siblings: O(depth + siblings along the path)
+ * instead of O(n). Copying a version is O(1), which makes snapshots free.
+ *
+ * Nodes do not know their parent, since they may be shared by many parents across versions. Node handles remember
+ * the path they were reached through instead, and they can only be used with the version they were obtained from.
+ *
+ * Nodes are never written once they are shared, and a node is only destroyed by the thread dropping its last
+ * reference, so distinct versions and handles may be read, modified into new versions and destroyed concurrently
+ * from different threads, as with any std::shared_ptr. A single version object follows the rules of the standard
+ * containers: concurrent const calls are safe, assigning to it while others read it is not.
+ */
+template <typename T>
+class persistent_general_tree
+{
+private:
+    struct private_node;
+    using node_ptr = std::shared_ptr<const private_node>;
+
+    struct private_node
+    {
+        T m_data;
+
+        node_ptr m_left_child;
+        node_ptr m_right_sibling;
+
+        template <typename... Args>
+        private_node(node_ptr left_child, node_ptr right_sibling, Args&&... args)
+            : m_data(std::forward<Args>(args)...), m_left_child(std::move(left_child)),
+              m_right_sibling(std::move(right_sibling))
+        {
+        }
+
+        private_node(const private_node&) = delete;
+        private_node& operator=(const private_node&) = delete;
+
+        ~private_node()
+        {
+            release_shared(std::move(m_right_sibling));
+            release_shared(std::move(m_left_child));
+        }
+    };
+
+    // persistent list of the ancestors of a node handle, shared by the handles of siblings and descendants
+    struct ancestor
+    {
+        node_ptr m_node;
+        std::size_t m_depth;
+        std::shared_ptr<const ancestor> m_up;
+
+        ancestor(node_ptr pnode, std::size_t depth, std::shared_ptr<const ancestor> up) noexcept
+            : m_node(std::move(pnode)), m_depth(depth), m_up(std::move(up))
+        {
+        }
+
+        ancestor(const ancestor&) = delete;
+        ancestor& operator=(const ancestor&) = delete;
+
+        ~ancestor()
+        {
+            release_shared(std::move(m_up));
+        }
+    };
+
+    using ancestor_ptr = std::shared_ptr<const ancestor>;
+
+    node_ptr m_root;
+
+    explicit persistent_general_tree(node_ptr root) noexcept : m_root(std::move(root)) {}
+
+    template <typename... Args>
+    static node_ptr make_node(node_ptr left_child, node_ptr right_sibling, Args&&... args)
+    {
+        return std::make_shared<const private_node>(std::move(left_child), std::move(right_sibling),
+                                                    std::forward<Args>(args)...);
+    }
+
+public:
+    /**
+     * @brief Public node interface
+     */
+    class node
+    {
+    private:
+        node_ptr m_node;
+        ancestor_ptr m_parent;
+        friend class persistent_general_tree;
+
+        node(node_ptr pnode, ancestor_ptr parent) noexcept : m_node(std::move(pnode)), m_parent(std::move(parent))
+        {
+        }
+
+    public:
+        node() noexcept = default;
+
+        bool operator==(const node& other) const noexcept
+        {
+            return m_node == other.m_node;
+        }
+
+        /**
+         * @brief Retrieves the left child of the current node.
+         * @return The left child node, or a null node if the current node has no left child.
+         */
+        [[nodiscard]] node left_child() const
+        {
+            if (m_node->m_left_child == nullptr)
+                return node();
+            return node(m_node->m_left_child, std::make_shared<const ancestor>(m_node, depth(), m_parent));
+        }
+
+        /**
+         * @brief Retrieves the parent of the current node.
+         * @return The parent node, or a null node if the current node has no parent.
+         */
+        [[nodiscard]] node parent() const noexcept
+        {
+            if (m_parent == nullptr)
+                return node();
+            return node(m_parent->m_node, m_parent->m_up);
+        }
+
+        /**
+         * @brief Retrieves the right sibling of the current node.
+         * @return The right sibling node, or a null node if the current node has no right sibling.
+         */
+        [[nodiscard]] node right_sibling() const noexcept
+        {
+            if (m_node->m_right_sibling == nullptr)
+                return node();
+            return node(m_node->m_right_sibling, m_parent);
+        }
+
+        /**
+         * @brief Accesses the data stored in the given node.
+         * @return const T& Reference to the data stored in the node.
+         * @throws std::invalid_argument If the given node is null.
+         */
+        [[nodiscard]] const T& data() const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot get data from null node");
+            return m_node->m_data;
+        }
+
+        /**
+         * @brief Checks if the node is the root of the tree.
+         * @return true if the node is the root, false otherwise.
+         */
+        bool is_root() const noexcept
+        {
+            return m_parent == nullptr;
+        }
+
+        /**
+         * @brief Checks if the node is a leaf in the tree.
+         * @return true if the node is a leaf, false otherwise.
+         */
+        bool is_leaf() const noexcept
+        {
+            return m_node->m_left_child == nullptr;
+        }
+
+        /**
+         * @brief Checks if the node has a right sibling.
+         * @return true if the node has a right sibling, false otherwise.
+         */
+        bool has_right_sibling() const noexcept
+        {
+            return m_node->m_right_sibling != nullptr;
+        }
+
+        /**
+         * @brief Checks if the node has a left child.
+         * @return true if the node has a left child, false otherwise.
+         */
+        bool has_left_child() const noexcept
+        {
+            return m_node->m_left_child != nullptr;
+        }
+
+        /**
+         * @brief Checks if the node is null.
+         * @return true if the node is null, false otherwise.
+         */
+        bool is_null() const noexcept
+        {
+            return m_node == nullptr;
+        }
+
+        /**
+         * @brief Retrieves the child node at the specified index.
+         * @param index The zero-based index of the child to retrieve.
+         * @return The child node at the specified index, or a null node if the index is out of range.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] node child(std::size_t index) const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot get child of null node");
+
+            node child = left_child();
+            for (std::size_t i = 0; i < index && !child.is_null(); i++)
+                child = child.right_sibling();
+
+            return child;
+        }
+
+        /**
+         * @brief Counts the number of children of the current node.
+         * @return The total number of children of the current node.
+         * @throws std::invalid_argument If the current node is null.
+         */
+        [[nodiscard]] std::size_t children_count() const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot count children of null node");
+
+            std::size_t count = 0;
+            for (const private_node* child = m_node->m_left_child.get(); child != nullptr;
+                 child = child->m_right_sibling.get())
+                ++count;
+
+            return count;
+        }
+
+        /**
+         * @brief Returns the depth of the current node in the tree, in O(1).
+         * @throws std::invalid_argument if the node is null.
+         */
+        [[nodiscard]] std::size_t depth() const
+        {
+            if (m_node == nullptr)
+                throw std::invalid_argument("Cannot get depth of null node");
+            return m_parent == nullptr ? 0 : m_parent->m_depth + 1;
+        }
+    };
+
+    persistent_general_tree() noexcept = default;
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U, T>>>
+    explicit persistent_general_tree(U&& root_value) : m_root(make_node(nullptr, nullptr, std::forward<U>(root_value)))
+    {
+    }
+
+    /**
+     * @brief Returns the root node of this version.
+     */
+    [[nodiscard]] node root() const noexcept
+    {
+        return node(m_root, nullptr);
+    }
+
+    /**
+     * @brief Checks whether the tree is empty.
+     */
+    bool empty() const noexcept
+    {
+        return m_root == nullptr;
+    }
+
+    /**
+     * @brief Returns a version with a new node, constructed in place from args, as the left child of the given node.
+     * @throws std::invalid_argument If the node is null or does not belong to this version.
+     */
+    template <typename... Args>
+    [[nodiscard]] persistent_general_tree emplace_left_child(const node& destiny, Args&&... args) const
+    {
+        check(destiny, "Cannot insert left child to null node");
+
+        const private_node& n = *destiny.m_node;
+        node_ptr child = make_node(nullptr, n.m_left_child, std::forward<Args>(args)...);
+        return replace(destiny, make_node(std::move(child), n.m_right_sibling, n.m_data));
+    }
+
+    /**
+     * @brief Returns a version with a copy of value as the left child of the given node.
+     * @throws std::invalid_argument If the node is null or does not belong to this version.
+     */
+    [[nodiscard]] persistent_general_tree insert_left_child(const node& destiny, const T& value) const
+    {
+        return emplace_left_child(destiny, value);
+    }
+
+    /**
+     * @brief Returns a version with a new node, constructed in place from args, as the right sibling of the given
+     * node.
+     * @throws std::invalid_argument If the node is null, is the root or does not belong to this version.
+     */
+    template <typename... Args>
+    [[nodiscard]] persistent_general_tree emplace_right_sibling(const node& destiny, Args&&... args) const
+    {
+        check(destiny, "Cannot insert right sibling to null node");
+        if (destiny.is_root())
+            throw std::invalid_argument("Cannot insert right sibling to root");
+
+        const private_node& n = *destiny.m_node;
+        node_ptr sibling = make_node(nullptr, n.m_right_sibling, std::forward<Args>(args)...);
+        return replace(destiny, make_node(n.m_left_child, std::move(sibling), n.m_data));
+    }
+
+    /**
+     * @brief Returns a version with a copy of value as the right sibling of the given node.
+     * @throws std::invalid_argument If the node is null, is the root or does not belong to this version.
+     */
+    [[nodiscard]] persistent_general_tree insert_right_sibling(const node& destiny, const T& value) const
+    {
+        return emplace_right_sibling(destiny, value);
+    }
+
+    /**
+     * @brief Returns a version without the left child of the given node and its descendants.
+     * @throws std::invalid_argument If the node is null or does not belong to this version.
+     */
+    [[nodiscard]] persistent_general_tree delete_left_child(const node& n) const
+    {
+        check(n, "Cannot delete left child of null node");
+        if (!n.has_left_child())
+            return *this;
+
+        const private_node& pnode = *n.m_node;
+        return replace(n, make_node(pnode.m_left_child->m_right_sibling, pnode.m_right_sibling, pnode.m_data));
+    }
+
+    /**
+     * @brief Returns a version without the right sibling of the given node and its descendants.
+     * @throws std::invalid_argument If the node is null or does not belong to this version.
+     */
+    [[nodiscard]] persistent_general_tree delete_right_sibling(const node& n) const
+    {
+        check(n, "Cannot delete right sibling of null node");
+        if (!n.has_right_sibling())
+            return *this;
+
+        const private_node& pnode = *n.m_node;
+        return replace(n, make_node(pnode.m_left_child, pnode.m_right_sibling->m_right_sibling, pnode.m_data));
+    }
+
+    /**
+     * @brief Returns a version where the value stored in the given node is replaced by value.
+     * @throws std::invalid_argument If the node is null or does not belong to this version.
+     */
+    template <typename U>
+    [[nodiscard]] persistent_general_tree update_data(const node& n, U&& value) const
+    {
+        check(n, "Cannot update data of null node");
+
+        const private_node& pnode = *n.m_node;
+        return replace(n, make_node(pnode.m_left_child, pnode.m_right_sibling, std::forward<U>(value)));
+    }
+
+    bool operator==(const persistent_general_tree& other) const
+    {
+        // Depth-first walk over both trees in lockstep, shared nodes are equal without being visited
+        std::vector<std::pair<const private_node*, const private_node*>> pending;
+        pending.emplace_back(m_root.get(), other.m_root.get());
+
+        while (!pending.empty())
+        {
+            auto [lhs, rhs] = pending.back();
+            pending.pop_back();
+
+            if (lhs == rhs)
+                continue;
+            if (lhs == nullptr || rhs == nullptr || lhs->m_data != rhs->m_data)
+                return false;
+
+            pending.emplace_back(lhs->m_right_sibling.get(), rhs->m_right_sibling.get());
+            pending.emplace_back(lhs->m_left_child.get(), rhs->m_left_child.get());
+        }
+
+        return true;
+    }
+
+private:
+    void check(const node& n, const char* null_message) const
+    {
+        if (n.is_null())
+            throw std::invalid_argument(null_message);
+
+        const private_node* top = n.m_parent == nullptr ? n.m_node.get() : nullptr;
+        for (const ancestor* a = n.m_parent.get(); a != nullptr; a = a->m_up.get())
+            top = a->m_node.get();
+
+        if (top != m_root.get())
+            throw std::invalid_argument("Node does not belong to this version");
+    }
+
+    // - replacement takes the place of n, it must already link to the children and right sibling it should have
+    // - copies every ancestor of n and the left siblings of n and of every ancestor
+    persistent_general_tree replace(const node& n, node_ptr replacement) const
+    {
+        const private_node* original = n.m_node.get();
+        for (const ancestor* a = n.m_parent.get(); a != nullptr; a = a->m_up.get())
+        {
+            const private_node& parent = *a->m_node;
+
+            // the left siblings of the original are rebuilt from right to left
+            std::vector<const private_node*> left_siblings;
+            for (const private_node* sibling = parent.m_left_child.get(); sibling != original;
+                 sibling = sibling->m_right_sibling.get())
+                left_siblings.push_back(sibling);
+
+            node_ptr first = std::move(replacement);
+            for (auto it = left_siblings.rbegin(); it != left_siblings.rend(); ++it)
+                first = make_node((*it)->m_left_child, std::move(first), (*it)->m_data);
+
+            replacement = make_node(std::move(first), parent.m_right_sibling, parent.m_data);
+            original = &parent;
+        }
+
+        return persistent_general_tree(std::move(replacement));
+    }
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Drops a reference to a shared object without recursing into the objects it references.
+ *
+ * Objects linked through std::shared_ptr, such as long chains of nodes, would otherwise be destroyed recursively and
+ * could overflow the stack. The destructor of such an object releases its links through this function: a release
+ * running inside a destructor only queues its reference, and the outermost release of the thread drops the queued
+ * ones one after the other. The reference counts alone decide which objects die and no object is written through a
+ * reference that might be shared, so objects sharing links can be released concurrently from different threads.
+ */
+template <typename Pointee>
+void release_shared(std::shared_ptr<const Pointee> pointer) noexcept
+{
+    thread_local std::vector<std::shared_ptr<const Pointee>>* t_queue = nullptr;
+
+    if (pointer == nullptr)
+        return;
+
+    if (t_queue != nullptr)
+    {
+        try
+        {
+            t_queue->push_back(std::move(pointer));
+        }
+        catch (...)
+        {
+            // without memory the reference is dropped here, which only costs one level of recursion
+        }
+        return;
+    }
+
+    std::vector<std::shared_ptr<const Pointee>> queue;
+    t_queue = &queue;
+    pointer.reset();
+    while (!queue.empty())
+    {
+        std::shared_ptr<const Pointee> next = std::move(queue.back());
+        queue.pop_back();
+        next.reset();
+    }
+    t_queue = nullptr;
+}
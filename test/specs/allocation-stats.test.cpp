@@ -0,0 +1,119 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using counted_tree = general_tree<std::string, std::allocator<std::string>, tree_feature::allocation_stats>;
+
+TEST_CASE("allocation stats")
+{
+    SUBCASE("count nodes and pages")
+    {
+        counted_tree gt("root");
+        for (int i = 0; i < 100; i++)
+            gt.insert_last_child(gt.root(), std::to_string(i));
+
+        auto stats = gt.memory_stats();
+        REQUIRE_EQ(stats.live_nodes, 101);
+        REQUIRE_EQ(stats.nodes_created, 101);
+        REQUIRE_EQ(stats.nodes_destroyed, 0);
+        REQUIRE_EQ(stats.bytes_used, gt.memory_usage(gt.root()));
+        REQUIRE_GE(stats.bytes_reserved, stats.bytes_used);
+        REQUIRE_GE(stats.allocations, 1);
+        REQUIRE_EQ(stats.frees, 0);
+
+        gt.delete_left_child(gt.root());
+        stats = gt.memory_stats();
+        REQUIRE_EQ(stats.live_nodes, 100);
+        REQUIRE_EQ(stats.peak_live_nodes, 101);
+        REQUIRE_EQ(stats.nodes_destroyed, 1);
+        REQUIRE_GT(stats.peak_bytes_used, stats.bytes_used);
+    }
+
+    SUBCASE("small batches grow the pages geometrically")
+    {
+        counted_tree single("root");
+        for (int i = 0; i < 10000; i++)
+            single.insert_last_child(single.root(), std::to_string(i));
+
+        counted_tree ones("root");
+        const std::vector<std::string> one{"x"};
+        for (int i = 0; i < 10000; i++)
+            ones.insert_last_children(ones.root(), one.begin(), one.end());
+
+        counted_tree twos("root");
+        const std::vector<std::string> two{"x", "y"};
+        for (int i = 0; i < 5000; i++)
+            twos.insert_last_children(twos.root(), two.begin(), two.end());
+
+        // pages double from 16 slots, so 10001 nodes take about log2(10001 / 16) of them
+        const auto pages = single.memory_stats().allocations;
+        REQUIRE_LE(pages, 16);
+        REQUIRE_LE(ones.memory_stats().allocations, pages + 1);
+        REQUIRE_LE(twos.memory_stats().allocations, pages + 1);
+        REQUIRE_EQ(ones.memory_stats().live_nodes, 10001);
+    }
+
+    SUBCASE("clear returns every page")
+    {
+        counted_tree gt("root");
+        for (int i = 0; i < 100; i++)
+            gt.insert_left_child(gt.root(), std::to_string(i));
+        const auto before = gt.memory_stats();
+
+        gt.clear();
+        const auto after = gt.memory_stats();
+        REQUIRE_EQ(after.live_nodes, 0);
+        REQUIRE_EQ(after.bytes_reserved, 0);
+        REQUIRE_EQ(after.frees, before.allocations);
+        REQUIRE_EQ(after.nodes_destroyed, 101);
+        REQUIRE_EQ(after.peak_bytes_reserved, before.bytes_reserved);
+
+        using int_tree = general_tree<int, std::allocator<int>, tree_feature::allocation_stats>;
+        int_tree trivial(0);
+        trivial.insert_left_child(trivial.root(), 1);
+        trivial.clear();
+        REQUIRE_EQ(trivial.memory_stats().live_nodes, 0);
+        REQUIRE_EQ(trivial.memory_stats().nodes_destroyed, 2);
+    }
+
+    SUBCASE("copies, moves and splices")
+    {
+        counted_tree gt("root");
+        gt.insert_left_child(gt.root(), "a");
+        gt.insert_left_child(gt.root(), "b");
+
+        counted_tree copy = gt;
+        REQUIRE_EQ(copy.memory_stats().live_nodes, 3);
+        REQUIRE_EQ(copy.memory_stats().nodes_created, 3);
+
+        counted_tree moved = std::move(copy);
+        REQUIRE_EQ(moved.memory_stats().live_nodes, 3);
+        REQUIRE_EQ(copy.memory_stats().live_nodes, 0);
+
+        gt.insert_last_child(gt.root(), moved);
+        REQUIRE_EQ(gt.memory_stats().live_nodes, 6);
+        REQUIRE_EQ(moved.memory_stats().live_nodes, 0);
+        REQUIRE_EQ(moved.memory_stats().bytes_reserved, 0);
+    }
+
+    SUBCASE("memory usage of a subtree")
+    {
+        general_tree<int> gt(0);
+        auto child = gt.insert_last_child(gt.root(), 1);
+        gt.insert_last_child(child, 2);
+        REQUIRE_EQ(gt.memory_usage(child) * 3, gt.memory_usage(gt.root()) * 2);
+        REQUIRE_THROWS_AS((void)gt.memory_usage(general_tree<int>::node()), std::invalid_argument);
+
+        using indexed_tree = general_tree<int, std::allocator<int>, tree_feature::indexed_children>;
+        indexed_tree indexed(0);
+        for (int i = 0; i < 10; i++)
+            indexed.insert_last_child(indexed.root(), i);
+        // the leaves have no index, the root indexes its ten children
+        const auto leaf = indexed.memory_usage(indexed.root().child(5));
+        REQUIRE_GE(indexed.memory_usage(indexed.root()), 11 * leaf + 10 * sizeof(void*));
+    }
+}
@@ -0,0 +1,162 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include "utils/fixtures/counting-allocator.fixture.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include <utility>
+
+using counted_tree = general_tree<int, CountingAllocator<int>>;
+
+TEST_CASE_FIXTURE(AllocationCounterFixture, "node storage")
+{
+    SUBCASE("nodes are allocated in pages rather than one by one")
+    {
+        counted_tree gt(0);
+        auto node = gt.root();
+        for (int i = 1; i < 1000; i++)
+            node = gt.insert_left_child(node, i);
+
+        CHECK_EQ(node.depth(), 999);
+        // page sizes grow geometrically, plus the page bookkeeping
+        CHECK_LT(AllocationCounter::allocate_calls, 20);
+    }
+
+    SUBCASE("storage of deleted nodes is reused")
+    {
+        counted_tree gt(0);
+        for (int i = 1; i < 10; i++)
+            gt.insert_left_child(gt.root(), i);
+        const unsigned allocations = AllocationCounter::allocate_calls;
+
+        gt.delete_left_child(gt.root());
+        gt.delete_left_child(gt.root());
+        gt.insert_left_child(gt.root(), 100);
+        gt.insert_left_child(gt.root(), 101);
+
+        CHECK_EQ(AllocationCounter::allocate_calls, allocations);
+        CHECK_EQ(gt.root().children_count(), 9);
+    }
+
+    SUBCASE("clear returns all the storage to the allocator")
+    {
+        counted_tree gt(0);
+        for (int i = 1; i < 100; i++)
+            gt.insert_left_child(gt.root(), i);
+
+        gt.clear();
+
+        CHECK_EQ(AllocationCounter::live_bytes, 0);
+        CHECK_EQ(AllocationCounter::allocate_calls, AllocationCounter::deallocate_calls);
+    }
+
+    SUBCASE("tree uses the provided allocator")
+    {
+        counted_tree gt(CountingAllocator<int>(7));
+        gt.emplace_root(1);
+        CHECK_EQ(gt.get_allocator().id(), 7);
+        CHECK_GT(AllocationCounter::allocate_calls, 0);
+    }
+
+    SUBCASE("destructor returns all the storage to the allocator")
+    {
+        {
+            counted_tree gt(0);
+            for (int i = 1; i < 100; i++)
+                gt.insert_left_child(gt.root(), i);
+        }
+        CHECK_EQ(AllocationCounter::live_bytes, 0);
+    }
+
+    SUBCASE("copy constructor uses the allocator selected for copy construction")
+    {
+        counted_tree gt(1, CountingAllocator<int>(3));
+        counted_tree copy(gt);
+        CHECK_EQ(copy.get_allocator().id(), 3);
+        CHECK_EQ(copy, gt);
+    }
+}
+
+TEST_CASE_FIXTURE(AllocationCounterFixture, "node storage when moving trees")
+{
+    SUBCASE("nodes are transferred when allocators are equal")
+    {
+        counted_tree gt(1);
+        gt.insert_left_child(gt.root(), 2);
+        auto root = gt.root();
+        counted_tree other(3);
+        const unsigned allocations = AllocationCounter::allocate_calls;
+
+        other = std::move(gt);
+
+        CHECK_EQ(other.root(), root);
+        CHECK_EQ(AllocationCounter::allocate_calls, allocations);
+    }
+
+    SUBCASE("values are moved when allocators are different")
+    {
+        general_tree<LifecycleCounter, CountingAllocator<LifecycleCounter>> gt(
+            LifecycleCounter("string1", 1), CountingAllocator<LifecycleCounter>(1)
+        );
+        gt.emplace_left_child(gt.root(), "string2", 2);
+        general_tree<LifecycleCounter, CountingAllocator<LifecycleCounter>> other(CountingAllocator<LifecycleCounter>(2));
+        LifecycleCounter::reset();
+
+        other = std::move(gt);
+
+        CHECK(gt.empty());
+        CHECK_EQ(other.get_allocator().id(), 2);
+        CHECK_EQ(other.root().left_child().data().get_int(), 2);
+        CHECK_EQ(LifecycleCounter::copy_constructor_calls, 0);
+        CHECK_EQ(LifecycleCounter::move_constructor_calls, 2);
+    }
+}
+
+TEST_CASE_FIXTURE(AllocationCounterFixture, "node storage when inserting trees")
+{
+    SUBCASE("inserted nodes are adopted when allocators are equal")
+    {
+        counted_tree gt(1);
+        counted_tree other(2);
+        auto other_root = other.root();
+        other.insert_left_child(other.root(), 3);
+
+        auto inserted = gt.insert_left_child(gt.root(), other);
+
+        CHECK_EQ(inserted, other_root);
+        CHECK(other.empty());
+        gt.clear();
+        other.clear();
+        CHECK_EQ(AllocationCounter::live_bytes, 0);
+    }
+
+    SUBCASE("inserted nodes are moved when allocators are different")
+    {
+        general_tree<LifecycleCounter, CountingAllocator<LifecycleCounter>> gt(
+            LifecycleCounter("string1", 1), CountingAllocator<LifecycleCounter>(1)
+        );
+        general_tree<LifecycleCounter, CountingAllocator<LifecycleCounter>> other(
+            LifecycleCounter("string2", 2), CountingAllocator<LifecycleCounter>(2)
+        );
+        other.emplace_left_child(other.root(), "string3", 3);
+        LifecycleCounter::reset();
+
+        auto inserted = gt.insert_right_sibling(gt.emplace_left_child(gt.root(), "string4", 4), other);
+
+        CHECK(other.empty());
+        CHECK_EQ(inserted.data().get_int(), 2);
+        CHECK_EQ(inserted.left_child().data().get_int(), 3);
+        CHECK_EQ(inserted.parent(), gt.root());
+        CHECK_EQ(LifecycleCounter::copy_constructor_calls, 0);
+        CHECK_EQ(LifecycleCounter::move_constructor_calls, 2);
+
+        gt.clear();
+        CHECK_EQ(AllocationCounter::live_bytes, 0);
+    }
+
+    SUBCASE("throw invalid argument if a tree is inserted into itself")
+    {
+        counted_tree gt(1);
+        auto child = gt.insert_left_child(gt.root(), 2);
+        REQUIRE_THROWS_AS(gt.insert_left_child(child, gt), std::invalid_argument);
+        REQUIRE_THROWS_AS(gt.insert_right_sibling(child, gt), std::invalid_argument);
+    }
+}
@@ -0,0 +1,141 @@
+#include "ancestry-index.h"
+#include "doctest.h"
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using tree = general_tree<int>;
+
+namespace
+{
+    // 1
+    // |-- 2
+    // |   |-- 5
+    // |   `-- 6
+    // |-- 3
+    // `-- 4
+    //     `-- 7
+    //         `-- 8
+    tree sample_tree()
+    {
+        tree gt(1);
+        auto n2 = gt.insert_left_child(gt.root(), 2);
+        gt.insert_left_child(n2, 5);
+        gt.insert_right_sibling(n2.left_child(), 6);
+        auto n3 = gt.insert_right_sibling(n2, 3);
+        auto n4 = gt.insert_right_sibling(n3, 4);
+        auto n7 = gt.insert_left_child(n4, 7);
+        gt.insert_left_child(n7, 8);
+        return gt;
+    }
+
+    tree::node find(const tree& gt, int value)
+    {
+        for (auto it = gt.preorder_begin(); it != gt.preorder_end(); ++it)
+        {
+            if (*it == value)
+                return it.get_node();
+        }
+        return tree::node();
+    }
+
+    tree::node naive_lca(tree::node a, tree::node b)
+    {
+        while (a.depth() > b.depth())
+            a = a.parent();
+        while (b.depth() > a.depth())
+            b = b.parent();
+        while (a != b)
+        {
+            a = a.parent();
+            b = b.parent();
+        }
+        return a;
+    }
+}
+
+TEST_CASE("ancestry index")
+{
+    SUBCASE("empty tree")
+    {
+        tree gt;
+        ancestry_index<tree> index(gt);
+        REQUIRE(index.empty());
+        REQUIRE_EQ(index.size(), 0);
+    }
+
+    SUBCASE("is ancestor")
+    {
+        const tree gt = sample_tree();
+        ancestry_index<tree> index(gt);
+        REQUIRE_EQ(index.size(), 8);
+
+        REQUIRE(index.is_ancestor(find(gt, 1), find(gt, 8)));
+        REQUIRE(index.is_ancestor(find(gt, 4), find(gt, 8)));
+        REQUIRE(index.is_ancestor(find(gt, 2), find(gt, 6)));
+        REQUIRE(index.is_ancestor(find(gt, 3), find(gt, 3)));
+        REQUIRE_FALSE(index.is_ancestor(find(gt, 8), find(gt, 4)));
+        REQUIRE_FALSE(index.is_ancestor(find(gt, 2), find(gt, 3)));
+        REQUIRE_FALSE(index.is_ancestor(find(gt, 5), find(gt, 6)));
+    }
+
+    SUBCASE("lowest common ancestor")
+    {
+        const tree gt = sample_tree();
+        ancestry_index<tree> index(gt);
+
+        REQUIRE_EQ(index.lca(find(gt, 5), find(gt, 6)).data(), 2);
+        REQUIRE_EQ(index.lca(find(gt, 6), find(gt, 8)).data(), 1);
+        REQUIRE_EQ(index.lca(find(gt, 8), find(gt, 4)).data(), 4);
+        REQUIRE_EQ(index.lca(find(gt, 4), find(gt, 8)).data(), 4);
+        REQUIRE_EQ(index.lca(find(gt, 3), find(gt, 3)).data(), 3);
+        REQUIRE_EQ(index.lca(find(gt, 1), find(gt, 7)).data(), 1);
+        REQUIRE_EQ(index.depth(find(gt, 8)), 3);
+    }
+
+    SUBCASE("matches parent walks on a random tree")
+    {
+        std::mt19937 rng(11);
+        tree gt(0);
+        std::vector<tree::node> nodes{gt.root()};
+        for (int i = 1; i < 300; i++)
+            nodes.push_back(gt.insert_last_child(nodes[rng() % nodes.size()], i));
+
+        ancestry_index<tree> index(gt);
+        for (int i = 0; i < 500; i++)
+        {
+            auto a = nodes[rng() % nodes.size()];
+            auto b = nodes[rng() % nodes.size()];
+            REQUIRE_EQ(index.lca(a, b), naive_lca(a, b));
+            REQUIRE_EQ(index.is_ancestor(a, b), naive_lca(a, b) == a);
+        }
+    }
+
+    SUBCASE("rejects nodes that were not indexed")
+    {
+        tree gt = sample_tree();
+        ancestry_index<tree> index(gt);
+        auto added = gt.insert_left_child(gt.root(), 9);
+
+        REQUIRE_FALSE(index.contains(added));
+        REQUIRE_THROWS_AS((void)index.lca(added, gt.root()), std::invalid_argument);
+        REQUIRE_THROWS_AS((void)index.is_ancestor(tree::node(), gt.root()), std::invalid_argument);
+    }
+
+    SUBCASE("rebuild picks up mutations")
+    {
+        tree gt = sample_tree();
+        ancestry_index<tree> index(gt);
+        auto added = gt.insert_left_child(find(gt, 5), 9);
+
+        index.rebuild(gt);
+        REQUIRE(index.contains(added));
+        REQUIRE_EQ(index.size(), 9);
+        REQUIRE_EQ(index.lca(added, find(gt, 6)).data(), 2);
+
+        index.clear();
+        REQUIRE(index.empty());
+        REQUIRE_FALSE(index.contains(added));
+    }
+}
@@ -0,0 +1,167 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    struct sum_policy
+    {
+        using value_type = long long;
+
+        static value_type from_value(int value) noexcept
+        {
+            return value;
+        }
+
+        static value_type combine(value_type lhs, value_type rhs) noexcept
+        {
+            return lhs + rhs;
+        }
+    };
+
+    // associative but not commutative: the values of the subtree in pre-order
+    struct preorder_policy
+    {
+        using value_type = std::string;
+
+        static value_type from_value(const std::string& value)
+        {
+            return value;
+        }
+
+        static value_type combine(const value_type& lhs, const value_type& rhs)
+        {
+            return lhs + rhs;
+        }
+    };
+
+    struct lazy_max_policy
+    {
+        static constexpr bool lazy = true;
+        static inline int recomputed = 0;
+
+        using value_type = int;
+
+        static value_type from_value(int value) noexcept
+        {
+            return value;
+        }
+
+        static value_type combine(value_type lhs, value_type rhs) noexcept
+        {
+            ++recomputed;
+            return std::max(lhs, rhs);
+        }
+    };
+
+    using sum_tree = general_tree<int, std::allocator<int>, tree_feature::none, sum_policy>;
+    using lazy_tree = general_tree<int, std::allocator<int>, tree_feature::left_sibling_links, lazy_max_policy>;
+
+    // the aggregate of every node matches a fold of its subtree
+    template <typename Tree, typename Fold>
+    void check_aggregates(typename Tree::node n, Fold fold)
+    {
+        REQUIRE_EQ(n.aggregate(), fold(n));
+        for (auto child = n.left_child(); !child.is_null(); child = child.right_sibling())
+            check_aggregates<Tree>(child, fold);
+    }
+
+    long long sum(sum_tree::node n)
+    {
+        long long total = 0;
+        for (int value : n.subtree())
+            total += value;
+        return total;
+    }
+
+    int max(lazy_tree::node n)
+    {
+        int highest = n.data();
+        for (int value : n.subtree())
+            highest = std::max(highest, value);
+        return highest;
+    }
+}
+
+TEST_CASE("augmentation")
+{
+    SUBCASE("follows every structural change")
+    {
+        sum_tree gt(1);
+        auto a = gt.insert_left_child(gt.root(), 2);
+        auto b = gt.insert_last_child(gt.root(), 3);
+        gt.insert_right_sibling(a, 4);
+        gt.emplace_last_children(b, std::vector<int>{5, 6, 7});
+        REQUIRE_EQ(gt.root().aggregate(), 28);
+
+        sum_tree other(10);
+        other.insert_left_child(other.root(), 20);
+        gt.insert_left_child(b, other);
+        REQUIRE_EQ(gt.root().aggregate(), 58);
+        check_aggregates<sum_tree>(gt.root(), sum);
+
+        gt.delete_left_child(b);
+        gt.delete_node(a);
+        REQUIRE_EQ(gt.root().aggregate(), 26);
+
+        gt.update_data(b.left_child(), 50);
+        REQUIRE_EQ(b.aggregate(), 66);
+        check_aggregates<sum_tree>(gt.root(), sum);
+
+        static_assert(std::is_const_v<std::remove_reference_t<decltype(gt.root().data())>>);
+    }
+
+    SUBCASE("copies and bulk builds")
+    {
+        const std::vector<int> values{1, 2, 3, 4, 5};
+        const std::vector<std::size_t> parents{sum_tree::no_parent, 0, 0, 1, 1};
+        auto gt = sum_tree::from_parent_array(values, parents);
+        REQUIRE_EQ(gt.root().left_child().aggregate(), 11);
+
+        sum_tree copy = gt;
+        check_aggregates<sum_tree>(copy.root(), sum);
+    }
+
+    SUBCASE("children are combined in sibling order")
+    {
+        using text_tree = general_tree<std::string, std::allocator<std::string>, tree_feature::none, preorder_policy>;
+        text_tree gt("a");
+        auto c = gt.insert_last_child(gt.root(), "c");
+        gt.insert_left_child(gt.root(), "b");
+        gt.insert_last_child(c, "d");
+        gt.insert_right_sibling(c, "e");
+        REQUIRE_EQ(gt.root().aggregate(), "abcde");
+
+        gt.update_data(c, "C");
+        REQUIRE_EQ(gt.root().aggregate(), "abCde");
+    }
+
+    SUBCASE("lazy aggregates are recomputed once for many updates")
+    {
+        std::mt19937 rng(3);
+        lazy_tree gt(0);
+        std::vector<lazy_tree::node> nodes{gt.root()};
+        for (int i = 1; i < 2000; i++)
+            nodes.push_back(gt.insert_last_child(nodes[rng() % nodes.size()], i));
+        check_aggregates<lazy_tree>(gt.root(), max);
+
+        lazy_max_policy::recomputed = 0;
+        for (int i = 0; i < 1000; i++)
+            gt.update_data(nodes[rng() % nodes.size()], static_cast<int>(rng() % 100000));
+        REQUIRE_EQ(lazy_max_policy::recomputed, 0);
+
+        (void)gt.root().aggregate();
+        REQUIRE_LT(lazy_max_policy::recomputed, 2000);
+        check_aggregates<lazy_tree>(gt.root(), max);
+
+        gt.delete_node(nodes[1]);
+        gt.insert_last_child(gt.root(), 1000000);
+        REQUIRE_EQ(gt.root().aggregate(), 1000000);
+        check_aggregates<lazy_tree>(gt.root(), max);
+    }
+}
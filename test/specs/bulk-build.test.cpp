@@ -0,0 +1,126 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t root = general_tree<int>::no_parent;
+
+    // 0
+    // |-- 1
+    // |   |-- 4
+    // |   `-- 5
+    // |-- 2
+    // `-- 3
+    //     `-- 6
+    const std::vector<int> sample_values{0, 1, 2, 3, 4, 5, 6};
+    const std::vector<std::size_t> sample_parents{root, 0, 0, 0, 1, 1, 3};
+
+    general_tree<int> built_by_hand()
+    {
+        general_tree<int> gt(0);
+        auto n1 = gt.insert_last_child(gt.root(), 1);
+        gt.insert_last_child(gt.root(), 2);
+        auto n3 = gt.insert_last_child(gt.root(), 3);
+        gt.insert_last_child(n1, 4);
+        gt.insert_last_child(n1, 5);
+        gt.insert_last_child(n3, 6);
+        return gt;
+    }
+}
+
+TEST_CASE("bulk build")
+{
+    SUBCASE("from a parent array")
+    {
+        auto gt = general_tree<int>::from_parent_array(sample_values, sample_parents);
+        REQUIRE(gt == built_by_hand());
+
+        // the tree keeps working as usual
+        gt.insert_last_child(gt.root(), 7);
+        gt.delete_node(gt.root().left_child());
+        REQUIRE_EQ(gt.root().children_count(), 3);
+    }
+
+    SUBCASE("children keep the order of their indices, wherever their parent is")
+    {
+        const std::vector<int> values{10, 11, 12, 13};
+        const std::vector<std::size_t> parents{3, 3, 3, root};
+        auto gt = general_tree<int>::from_parent_array(values, parents);
+
+        std::vector<int> expected{13, 10, 11, 12};
+        std::vector<int> preorder(gt.preorder_begin(), gt.preorder_end());
+        REQUIRE_EQ(preorder, expected);
+    }
+
+    SUBCASE("maintains the bookkeeping of every feature")
+    {
+        using full_tree = general_tree<int, std::allocator<int>,
+                                       tree_feature::indexed_children | tree_feature::left_sibling_links |
+                                           tree_feature::subtree_sizes | tree_feature::cached_depth |
+                                           tree_feature::structural_hash>;
+
+        auto gt = full_tree::from_parent_array(sample_values, sample_parents);
+        REQUIRE_EQ(gt.root().descendants_count(), 6);
+        REQUIRE_EQ(gt.root().left_child().descendants_count(), 2);
+        REQUIRE_EQ(gt.root().child(2).left_child().depth(), 2);
+        REQUIRE_EQ(gt.root().child(2).left_sibling().data(), 2);
+        REQUIRE_EQ(gt.root().descendant_at(5).data(), 3);
+
+        auto copy = gt;
+        auto rebuilt = full_tree::from_preorder_depths(
+            std::vector<std::pair<std::size_t, int>>{{0, 0}, {1, 1}, {2, 4}, {2, 5}, {1, 2}, {1, 3}, {2, 6}});
+        REQUIRE_EQ(rebuilt.root().subtree_hash(), gt.root().subtree_hash());
+        REQUIRE(rebuilt == copy);
+    }
+
+    SUBCASE("from pre-order depths")
+    {
+        std::vector<std::pair<std::size_t, int>> nodes{{0, 0}, {1, 1}, {2, 4}, {2, 5}, {1, 2}, {1, 3}, {2, 6}};
+        auto gt = general_tree<int>::from_preorder_depths(nodes);
+        REQUIRE(gt == built_by_hand());
+
+        REQUIRE(general_tree<int>::from_preorder_depths(std::vector<std::pair<int, int>>{}).empty());
+    }
+
+    SUBCASE("empty input")
+    {
+        auto gt = general_tree<int>::from_parent_array({}, {});
+        REQUIRE(gt.empty());
+    }
+
+    SUBCASE("rejects invalid input")
+    {
+        using tree = general_tree<int>;
+        const std::vector<int> values{0, 1, 2};
+
+        const std::vector<std::size_t> short_parents{root, 0};
+        const std::vector<std::size_t> two_roots{root, 0, root};
+        const std::vector<std::size_t> no_root{1, 2, 0};
+        const std::vector<std::size_t> out_of_range{root, 0, 3};
+        const std::vector<std::size_t> cycle{root, 2, 1};
+        REQUIRE_THROWS_AS(tree::from_parent_array(values, short_parents), std::invalid_argument);
+        REQUIRE_THROWS_AS(tree::from_parent_array(values, two_roots), std::invalid_argument);
+        REQUIRE_THROWS_AS(tree::from_parent_array(values, no_root), std::invalid_argument);
+        REQUIRE_THROWS_AS(tree::from_parent_array(values, out_of_range), std::invalid_argument);
+        REQUIRE_THROWS_AS(tree::from_parent_array(values, cycle), std::invalid_argument);
+
+        const std::vector<std::pair<std::size_t, int>> not_root_first{{1, 0}, {2, 1}};
+        const std::vector<std::pair<std::size_t, int>> second_root{{0, 0}, {1, 1}, {0, 2}};
+        const std::vector<std::pair<std::size_t, int>> skipped_level{{0, 0}, {2, 1}};
+        REQUIRE_THROWS_AS(tree::from_preorder_depths(not_root_first), std::invalid_argument);
+        REQUIRE_THROWS_AS(tree::from_preorder_depths(second_root), std::invalid_argument);
+        REQUIRE_THROWS_AS(tree::from_preorder_depths(skipped_level), std::invalid_argument);
+
+        const std::vector<std::pair<int, int>> negative_root{{-1, 0}};
+        const std::vector<std::pair<int, int>> negative_child{{0, 0}, {1, 1}, {-1, 2}};
+        const std::vector<std::pair<int, int>> signed_depths{{0, 0}, {1, 1}, {2, 2}, {1, 3}};
+        REQUIRE_THROWS_AS(tree::from_preorder_depths(negative_root), std::invalid_argument);
+        REQUIRE_THROWS_AS(tree::from_preorder_depths(negative_child), std::invalid_argument);
+        REQUIRE_EQ(tree::from_preorder_depths(signed_depths).root().children_count(), 2);
+    }
+}
@@ -0,0 +1,82 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <cstddef>
+#include <memory>
+
+using depth_tree = general_tree<int, std::allocator<int>, tree_feature::cached_depth>;
+
+namespace
+{
+    // compares the cached depth of every node against the number of parent links to the root
+    void check_depths(depth_tree::node n)
+    {
+        std::size_t expected = 0;
+        for (auto aux = n.parent(); !aux.is_null(); aux = aux.parent())
+            ++expected;
+
+        REQUIRE_EQ(n.depth(), expected);
+        for (auto child = n.left_child(); !child.is_null(); child = child.right_sibling())
+            check_depths(child);
+    }
+}
+
+TEST_CASE("cached depth")
+{
+    SUBCASE("set on every kind of insertion")
+    {
+        depth_tree gt(0);
+        auto a = gt.insert_left_child(gt.root(), 1);
+        auto b = gt.insert_last_child(a, 2);
+        auto c = gt.insert_right_sibling(b, 3);
+
+        REQUIRE_EQ(gt.root().depth(), 0);
+        REQUIRE_EQ(a.depth(), 1);
+        REQUIRE_EQ(b.depth(), 2);
+        REQUIRE_EQ(c.depth(), 2);
+    }
+
+    SUBCASE("fixed up when a tree is spliced in")
+    {
+        depth_tree gt(0);
+        auto a = gt.insert_left_child(gt.root(), 1);
+        auto b = gt.insert_left_child(a, 2);
+
+        depth_tree other(10);
+        auto x = other.insert_left_child(other.root(), 11);
+        other.insert_last_child(x, 12);
+        other.insert_right_sibling(x, 13);
+        gt.insert_left_child(b, other);
+
+        depth_tree other2(20);
+        other2.insert_left_child(other2.root(), 21);
+        gt.insert_right_sibling(b, other2);
+
+        depth_tree other3(30);
+        other3.insert_last_child(other3.root(), 31);
+        gt.insert_last_child(gt.root(), other3);
+
+        check_depths(gt.root());
+        REQUIRE_EQ(b.left_child().left_child().left_child().depth(), 5);
+    }
+
+    SUBCASE("copies keep the depths")
+    {
+        depth_tree gt(0);
+        auto a = gt.insert_left_child(gt.root(), 1);
+        gt.insert_left_child(a, 2);
+
+        depth_tree copy(gt);
+        check_depths(copy.root());
+        REQUIRE_EQ(copy.root().left_child().left_child().depth(), 2);
+    }
+
+    SUBCASE("deep chain")
+    {
+        depth_tree gt(0);
+        auto current = gt.root();
+        for (int i = 1; i <= 5000; i++)
+            current = gt.insert_left_child(current, i);
+
+        REQUIRE_EQ(current.depth(), 5000);
+    }
+}
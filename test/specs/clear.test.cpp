@@ -13,6 +13,25 @@ TEST_CASE_FIXTURE(LifecycleCounterFixture, "clear")
         REQUIRE_EQ(LifecycleCounter::destructor_calls, gt_size);
     }
 
+    SUBCASE("delete all nodes from deep and wide trees")
+    {
+        const std::size_t gt_size = 10000;
+
+        general_tree<LifecycleCounter> deep(LifecycleCounter("string0", 0));
+        auto node = deep.root();
+        for (std::size_t i = 1; i < gt_size; i++)
+            node = deep.emplace_left_child(node, "string", static_cast<int>(i));
+
+        general_tree<LifecycleCounter> wide(LifecycleCounter("string0", 0));
+        for (std::size_t i = 1; i < gt_size; i++)
+            wide.emplace_left_child(wide.root(), "string", static_cast<int>(i));
+
+        LifecycleCounter::reset();
+        deep.clear();
+        wide.clear();
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 2 * gt_size);
+    }
+
     SUBCASE("tree is empty after clear")
     {
         general_tree<LifecycleCounter> gt = seed_tree(5);
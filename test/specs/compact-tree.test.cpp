@@ -0,0 +1,181 @@
+#include "compact-tree.h"
+#include "doctest.h"
+#include <cstddef>
+#include <iterator>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // 0
+    // |-- 1
+    // |   |-- 2
+    // |   `-- 3
+    // |-- 1
+    // |   |-- 2
+    // |   `-- 3
+    // `-- 1
+    //     `-- 2
+    general_tree<int> repeated_tree()
+    {
+        general_tree<int> gt(0);
+        for (int i = 0; i < 2; i++)
+        {
+            auto n1 = gt.insert_last_child(gt.root(), 1);
+            gt.insert_last_child(n1, 2);
+            gt.insert_last_child(n1, 3);
+        }
+        auto n1 = gt.insert_last_child(gt.root(), 1);
+        gt.insert_last_child(n1, 2);
+        return gt;
+    }
+
+    template <typename Node>
+    void expand(Node n, std::vector<int>& values)
+    {
+        values.push_back(n.data());
+        for (auto child = n.left_child(); !child.is_null(); child = child.right_sibling())
+            expand(child, values);
+    }
+}
+
+TEST_CASE("compact tree")
+{
+    SUBCASE("empty tree")
+    {
+        general_tree<int> gt;
+        auto compact = gt.compact_shared();
+        REQUIRE(compact.empty());
+        REQUIRE(compact.root().is_null());
+        REQUIRE_EQ(compact.size(), 0);
+    }
+
+    SUBCASE("stores identical subtrees once")
+    {
+        auto compact = repeated_tree().compact_shared();
+
+        // 2, 3, 1(2 3), 1(2), 0
+        REQUIRE_EQ(compact.distinct_count(), 5);
+        REQUIRE_EQ(compact.size(), 9);
+        REQUIRE_EQ(compact.root().child(0).subtree_id(), compact.root().child(1).subtree_id());
+        REQUIRE_NE(compact.root().child(1).subtree_id(), compact.root().child(2).subtree_id());
+    }
+
+    SUBCASE("expands to the original tree")
+    {
+        auto gt = repeated_tree();
+        auto compact = gt.compact_shared();
+
+        std::vector<int> expected;
+        std::vector<int> values;
+        expand(gt.root(), expected);
+        expand(compact.root(), values);
+        REQUIRE_EQ(values, expected);
+        REQUIRE_EQ(compact.root().descendants_count(), 8);
+    }
+
+    SUBCASE("pre-order iterator")
+    {
+        auto gt = repeated_tree();
+        auto compact = gt.compact_shared();
+
+        std::vector<int> expected(gt.preorder_begin(), gt.preorder_end());
+        std::vector<int> values(compact.preorder_begin(), compact.preorder_end());
+        REQUIRE_EQ(values, expected);
+
+        // 0, 1, 2, 3, 1, 2, 3, 1, 2
+        const std::vector<std::size_t> expected_depths{0, 1, 2, 2, 1, 2, 2, 1, 2};
+        std::vector<std::size_t> depths;
+        auto it = compact.preorder_begin();
+        for (; it != compact.preorder_end(); ++it)
+        {
+            depths.push_back(it.depth());
+            REQUIRE_EQ(it.get_node().depth(), it.depth());
+            REQUIRE_EQ(it.get_node().subtree_id(), it.subtree_id());
+        }
+        REQUIRE_EQ(depths, expected_depths);
+
+        // the handle of an iterator is the one reached by navigation
+        it = compact.preorder_begin();
+        for (int i = 0; i < 6; i++)
+            ++it;
+        REQUIRE_EQ(*it, 3);
+        REQUIRE_EQ(it.get_node(), compact.root().child(1).child(1));
+        REQUIRE_NE(it.get_node(), compact.root().child(0).child(1));
+
+        compact_tree<int> empty;
+        REQUIRE(empty.preorder_begin() == empty.preorder_end());
+        static_assert(std::forward_iterator<compact_tree<int>::preorder_iterator>);
+    }
+
+    SUBCASE("navigation through shared subtrees")
+    {
+        auto compact = repeated_tree().compact_shared();
+        auto first = compact.root().left_child();
+        auto second = first.right_sibling();
+        auto leaf = second.left_child().right_sibling();
+
+        REQUIRE_EQ(leaf.data(), 3);
+        REQUIRE_EQ(leaf.depth(), 2);
+        REQUIRE(leaf.is_leaf());
+        REQUIRE_FALSE(leaf.has_right_sibling());
+        REQUIRE_EQ(leaf.parent(), second);
+        REQUIRE_NE(leaf.parent(), first);
+        REQUIRE_EQ(leaf.parent().parent(), compact.root());
+        REQUIRE_EQ(second.children_count(), 2);
+        REQUIRE(second.child(2).is_null());
+    }
+
+    SUBCASE("deep paths sharing frames are released from several threads")
+    {
+        constexpr int depth = 100000;
+        general_tree<int> gt(0);
+        auto last = gt.root();
+        for (int i = 1; i < depth; i++)
+            last = gt.insert_last_child(last, i % 3);
+        auto compact = gt.compact_shared();
+
+        auto deepest = compact.preorder_begin();
+        for (int i = 1; i < depth; i++)
+            ++deepest;
+        REQUIRE_EQ(deepest.depth(), static_cast<std::size_t>(depth - 1));
+
+        // the threads read and drop their copies of the same path together, the last of them releases the whole path
+        for (int round = 0; round < 50; round++)
+        {
+            auto handle = deepest.get_node();
+            std::latch start(4);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; t++)
+            {
+                threads.emplace_back([&start, it = deepest, n = handle.parent().left_child()]() mutable {
+                    start.arrive_and_wait();
+                    for (int i = 0; i < 10; i++)
+                        n = n.parent();
+                    it = compact_tree<int>::preorder_iterator();
+                    n = compact_tree<int>::node();
+                });
+            }
+            handle = compact_tree<int>::node();
+            for (auto& thread : threads)
+                thread.join();
+        }
+        deepest = compact_tree<int>::preorder_iterator();
+        REQUIRE_EQ(compact.root().data(), 0);
+    }
+
+    SUBCASE("values are compared, not only hashed")
+    {
+        general_tree<std::string> gt("root");
+        for (int i = 0; i < 100; i++)
+            gt.insert_last_child(gt.root(), std::to_string(i % 10));
+
+        auto compact = gt.compact_shared();
+        REQUIRE_EQ(compact.distinct_count(), 11);
+        REQUIRE_EQ(compact.root().child(42).data(), "2");
+        REQUIRE_THROWS_AS((void)compact_tree<std::string>::node().data(), std::invalid_argument);
+    }
+}
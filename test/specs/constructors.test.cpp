@@ -33,6 +33,20 @@ TEST_CASE_FIXTURE(LifecycleCounterFixture, "copy constructor")
         REQUIRE_EQ(new_tree, gt);
     }
 
+    SUBCASE("parents of the copied nodes belong to the new tree")
+    {
+        general_tree<int> gt(0);
+        auto child = gt.insert_left_child(gt.root(), 1);
+        gt.insert_right_sibling(child, 2);
+        gt.insert_left_child(child, 3);
+
+        general_tree<int> new_tree(gt);
+        REQUIRE_EQ(new_tree.root().left_child().parent(), new_tree.root());
+        REQUIRE_EQ(new_tree.root().child(1).parent(), new_tree.root());
+        REQUIRE_EQ(new_tree.root().left_child().left_child().parent(), new_tree.root().left_child());
+        REQUIRE_EQ(new_tree.root().left_child().left_child().depth(), 2);
+    }
+
     SUBCASE("copy tree with only one node")
     {
         general_tree<int> gt(1);
@@ -168,3 +182,34 @@ TEST_CASE_FIXTURE(LifecycleCounterFixture, "move constructor")
         REQUIRE_EQ(LifecycleCounter::destructor_calls, 3);
     }
 }
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "destructor")
+{
+    SUBCASE("destroy every node when the tree goes out of scope")
+    {
+        {
+            general_tree<LifecycleCounter> gt = seed_tree(12);
+        }
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 12);
+    }
+
+    SUBCASE("no error if the tree is empty")
+    {
+        {
+            general_tree<LifecycleCounter> gt;
+        }
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 0);
+    }
+
+    SUBCASE("moved-from tree does not destroy the moved nodes")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(4);
+        {
+            auto moved_from = seed_tree(4);
+            gt = std::move(moved_from);
+            LifecycleCounter::reset();
+        }
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 0);
+        REQUIRE_EQ(gt.root().descendants_count(), 3);
+    }
+}
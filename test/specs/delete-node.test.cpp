@@ -1,5 +1,6 @@
 #include "general-tree.h"
 #include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
 #include <doctest.h>
 #include <stdexcept>
 
@@ -153,6 +154,22 @@ TEST_CASE_FIXTURE(LifecycleCounterFixture, "delete right sibling")
         REQUIRE_EQ(node.right_sibling(), next_sibling);
     }
 
+    SUBCASE("siblings of the deleted node are kept")
+    {
+        general_tree<int> gt(1);
+        const auto first = gt.insert_left_child(gt.root(), 2);
+        const auto middle = gt.insert_right_sibling(first, 3);
+        const auto last = gt.insert_right_sibling(middle, 4);
+        gt.insert_left_child(middle, 5);
+        gt.insert_right_sibling(gt.insert_left_child(last, 6), 7);
+
+        gt.delete_right_sibling(first);
+
+        REQUIRE_EQ(first.right_sibling(), last);
+        REQUIRE_EQ(last.children_count(), 2);
+        REQUIRE_EQ(gt.root().descendants_count(), 4);
+    }
+
     SUBCASE("parent's children count is decreased")
     {
         general_tree<int> gt(1);
@@ -166,3 +183,59 @@ TEST_CASE_FIXTURE(LifecycleCounterFixture, "delete right sibling")
         REQUIRE_EQ(gt.root().children_count(), 3);
     }
 }
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "delete node")
+{
+    SUBCASE("delete the node and all the nodes hanging from it")
+    {
+        general_tree<LifecycleCounter> gt;
+        gt.emplace_root("string1", 1);
+        const auto child1 = gt.emplace_left_child(gt.root(), "string2", 2);
+        const auto child2 = gt.emplace_right_sibling(child1, "string3", 3);
+        const auto child3 = gt.emplace_right_sibling(child2, "string4", 4);
+        gt.emplace_left_child(child2, "string5", 5);
+
+        gt.delete_node(child2);
+
+        CHECK_EQ(LifecycleCounter::destructor_calls, 2);
+        CHECK_EQ(child1.right_sibling(), child3);
+        CHECK_EQ(gt.root().children_count(), 2);
+    }
+
+    SUBCASE("deleting the first child makes the next child the new left child")
+    {
+        general_tree<int> gt(1);
+        const auto next_child = gt.insert_left_child(gt.root(), 2);
+        const auto doomed = gt.insert_left_child(gt.root(), 3);
+
+        gt.delete_node(doomed);
+
+        REQUIRE_EQ(gt.root().left_child(), next_child);
+    }
+
+    SUBCASE("deleting the last child updates the last child")
+    {
+        general_tree<int> gt(1);
+        const auto first = gt.insert_last_child(gt.root(), 2);
+        const auto last = gt.insert_last_child(gt.root(), 3);
+
+        gt.delete_node(last);
+
+        REQUIRE_EQ(gt.root().last_child(), first);
+        REQUIRE(first.right_sibling().is_null());
+    }
+
+    SUBCASE("deleting the root clears the tree")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(6);
+        gt.delete_node(gt.root());
+        CHECK(gt.empty());
+        CHECK_EQ(LifecycleCounter::destructor_calls, 6);
+    }
+
+    SUBCASE("throw invalid argument if node is null")
+    {
+        general_tree<int> gt(1);
+        REQUIRE_THROWS_AS(gt.delete_node(gt.root().left_child()), std::invalid_argument);
+    }
+}
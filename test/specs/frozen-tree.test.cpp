@@ -0,0 +1,126 @@
+#include "doctest.h"
+#include "frozen-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    // 1
+    // |-- 2
+    // |   |-- 5
+    // |   `-- 6
+    // |-- 3
+    // `-- 4
+    //     `-- 7
+    general_tree<int> sample_tree()
+    {
+        general_tree<int> gt(1);
+        auto n2 = gt.insert_left_child(gt.root(), 2);
+        auto n3 = gt.insert_right_sibling(n2, 3);
+        auto n4 = gt.insert_right_sibling(n3, 4);
+        gt.insert_right_sibling(gt.insert_left_child(n2, 5), 6);
+        gt.insert_left_child(n4, 7);
+        return gt;
+    }
+}
+
+TEST_CASE("frozen_tree")
+{
+    SUBCASE("values are laid out in pre-order")
+    {
+        const frozen_tree<int> frozen = sample_tree().freeze();
+        const std::vector<int> values(frozen.begin(), frozen.end());
+        const std::vector<int> expected{1, 2, 5, 6, 3, 4, 7};
+        REQUIRE_EQ(values, expected);
+        REQUIRE_EQ(frozen.size(), 7);
+    }
+
+    SUBCASE("navigation matches the original tree")
+    {
+        const auto gt = sample_tree();
+        const auto frozen = gt.freeze();
+        auto root = frozen.root();
+
+        REQUIRE(root.is_root());
+        REQUIRE(root.parent().is_null());
+        REQUIRE(root.right_sibling().is_null());
+        REQUIRE_EQ(root.left_child().data(), 2);
+        REQUIRE_EQ(root.left_child().right_sibling().data(), 3);
+        REQUIRE_EQ(root.child(2).data(), 4);
+        REQUIRE(root.child(3).is_null());
+        REQUIRE_EQ(root.child(2).left_child().data(), 7);
+        REQUIRE_EQ(root.child(2).left_child().parent(), root.child(2));
+        REQUIRE(root.left_child().left_child().right_sibling().right_sibling().is_null());
+        REQUIRE(root.child(1).is_leaf());
+        REQUIRE_FALSE(root.child(2).has_right_sibling());
+    }
+
+    SUBCASE("counts and depth")
+    {
+        const auto frozen = sample_tree().freeze();
+        auto root = frozen.root();
+
+        REQUIRE_EQ(root.children_count(), 3);
+        REQUIRE_EQ(root.descendants_count(), 6);
+        REQUIRE_EQ(root.left_child().descendants_count(), 2);
+        REQUIRE_EQ(root.child(2).left_child().depth(), 2);
+    }
+
+    SUBCASE("subtree is a contiguous pre-order slice")
+    {
+        const auto frozen = sample_tree().freeze();
+        auto subtree = frozen.root().left_child().subtree();
+        const std::vector<int> values(subtree.begin(), subtree.end());
+        const std::vector<int> expected{2, 5, 6};
+        REQUIRE_EQ(values, expected);
+    }
+
+    SUBCASE("nodes can be retrieved by pre-order position")
+    {
+        const auto frozen = sample_tree().freeze();
+        REQUIRE_EQ(frozen.at(4).data(), 3);
+        REQUIRE_EQ(frozen.at(4).index(), 4);
+        REQUIRE_THROWS_AS(frozen.at(7), std::out_of_range);
+    }
+
+    SUBCASE("empty tree produces an empty snapshot")
+    {
+        general_tree<int> gt;
+        const auto frozen = gt.freeze();
+        REQUIRE(frozen.empty());
+        REQUIRE(frozen.root().is_null());
+        REQUIRE_THROWS_AS(frozen.root().data(), std::invalid_argument);
+    }
+
+    SUBCASE("snapshots of equal trees are equal")
+    {
+        REQUIRE(sample_tree().freeze() == sample_tree().freeze());
+
+        auto other = sample_tree();
+        other.insert_left_child(other.root().child(1), 8);
+        REQUIRE_FALSE(sample_tree().freeze() == other.freeze());
+    }
+
+    SUBCASE("snapshot is independent from the original tree")
+    {
+        auto gt = sample_tree();
+        const auto frozen = gt.freeze();
+        gt.clear();
+        REQUIRE_EQ(frozen.root().child(2).left_child().data(), 7);
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "frozen_tree (values)")
+{
+    SUBCASE("copy each value once")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(50);
+        const auto frozen = gt.freeze();
+        REQUIRE_EQ(frozen.size(), 50);
+        REQUIRE_EQ(LifecycleCounter::copy_constructor_calls, 50);
+        REQUIRE_EQ(frozen.root().descendants_count(), gt.root().descendants_count());
+        REQUIRE_EQ(frozen.root().child(1).left_child().data(), gt.root().child(1).left_child().data());
+    }
+}
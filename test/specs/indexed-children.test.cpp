@@ -0,0 +1,184 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <memory>
+#include <vector>
+
+using indexed_tree = general_tree<int, std::allocator<int>, tree_feature::indexed_children>;
+
+TEST_CASE("indexed children")
+{
+    SUBCASE("children count follows insertions")
+    {
+        indexed_tree gt(0);
+        auto first = gt.insert_left_child(gt.root(), 1);
+        gt.insert_right_sibling(first, 2);
+        gt.insert_left_child(gt.root(), 3);
+        REQUIRE_EQ(gt.root().children_count(), 3);
+        REQUIRE_EQ(first.children_count(), 0);
+    }
+
+    SUBCASE("children count follows deletions")
+    {
+        indexed_tree gt(0);
+        for (int i = 1; i <= 5; i++)
+            gt.insert_left_child(gt.root(), i);
+
+        gt.delete_left_child(gt.root());
+        gt.delete_right_sibling(gt.root().child(1));
+
+        REQUIRE_EQ(gt.root().children_count(), 3);
+    }
+
+    SUBCASE("children count follows inserted trees")
+    {
+        indexed_tree gt(0);
+        auto child = gt.insert_left_child(gt.root(), 1);
+        indexed_tree other(2);
+        other.insert_left_child(other.root(), 3);
+        indexed_tree other2(4);
+
+        gt.insert_left_child(gt.root(), other);
+        gt.insert_right_sibling(child, other2);
+
+        REQUIRE_EQ(gt.root().children_count(), 3);
+        REQUIRE_EQ(gt.root().left_child().children_count(), 1);
+    }
+
+    SUBCASE("child returns the requested child after every change")
+    {
+        indexed_tree gt(0);
+        auto last = gt.insert_left_child(gt.root(), 10);
+        REQUIRE_EQ(gt.root().child(0), last);
+
+        auto first = gt.insert_left_child(gt.root(), 5);
+        REQUIRE_EQ(gt.root().child(0), first);
+        REQUIRE_EQ(gt.root().child(1), last);
+
+        auto middle = gt.insert_right_sibling(first, 7);
+        REQUIRE_EQ(gt.root().child(1), middle);
+        REQUIRE_EQ(gt.root().child(2), last);
+
+        gt.delete_right_sibling(first);
+        REQUIRE_EQ(gt.root().child(1), last);
+        REQUIRE(gt.root().child(2).is_null());
+    }
+
+    SUBCASE("child follows runs of changes at both ends")
+    {
+        indexed_tree gt(0);
+        auto root = gt.root();
+        auto check = [&root] {
+            std::size_t index = 0;
+            for (auto child = root.left_child(); !child.is_null(); child = child.right_sibling(), index++)
+                REQUIRE_EQ(root.child(index), child);
+            REQUIRE_EQ(root.children_count(), index);
+        };
+
+        // a queue of children, added at the back and taken from the front
+        for (int i = 0; i < 100; i++)
+        {
+            gt.insert_last_child(root, i);
+            gt.insert_last_child(root, i);
+            gt.delete_left_child(root);
+        }
+        check();
+
+        for (int i = 0; i < 100; i++)
+            gt.insert_left_child(root, -i);
+        check();
+
+        const std::vector<int> values{1000, 1001, 1002};
+        gt.insert_left_children(root, values.begin(), values.end());
+        gt.insert_last_children(root, values.begin(), values.end());
+        REQUIRE_EQ(root.child(0).data(), 1000);
+        REQUIRE_EQ(root.child(root.children_count() - 1).data(), 1002);
+        check();
+
+        while (root.children_count() > 1)
+        {
+            gt.delete_node(root.child(root.children_count() / 2));
+            gt.delete_node(root.last_child());
+            check();
+        }
+    }
+
+    SUBCASE("return null node when index is out of range")
+    {
+        indexed_tree gt(0);
+        REQUIRE(gt.root().child(0).is_null());
+        gt.insert_left_child(gt.root(), 1);
+        REQUIRE(gt.root().child(1).is_null());
+    }
+
+    SUBCASE("copies keep the children count")
+    {
+        indexed_tree gt(0);
+        for (int i = 1; i <= 4; i++)
+            gt.insert_left_child(gt.insert_left_child(gt.root(), i), i * 10);
+
+        indexed_tree copy(gt);
+        REQUIRE_EQ(copy.root().children_count(), 4);
+        REQUIRE_EQ(copy.root().child(3).children_count(), 1);
+        REQUIRE_EQ(copy.root().child(3).left_child().data(), 10);
+    }
+
+    SUBCASE("same answers as the default mode on random changes")
+    {
+        general_tree<int> plain(0);
+        indexed_tree indexed(0);
+        std::vector<general_tree<int>::node> plain_nodes{plain.root()};
+        std::vector<indexed_tree::node> indexed_nodes{indexed.root()};
+
+        unsigned seed = 12345;
+        auto next_random = [&seed](unsigned bound) {
+            seed = seed * 1103515245u + 12345u;
+            return (seed >> 16) % bound;
+        };
+
+        for (int i = 1; i < 400; i++)
+        {
+            const unsigned target = next_random(static_cast<unsigned>(plain_nodes.size()));
+            const unsigned action = next_random(4);
+
+            if (action == 0 && !plain_nodes[target].is_root())
+            {
+                plain_nodes.push_back(plain.insert_right_sibling(plain_nodes[target], i));
+                indexed_nodes.push_back(indexed.insert_right_sibling(indexed_nodes[target], i));
+            }
+            else if (action == 1 && plain_nodes[target].has_right_sibling() &&
+                     plain_nodes[target].right_sibling().is_leaf())
+            {
+                // only leaves are deleted, so the recorded handles stay valid
+                const auto plain_target = plain_nodes[target];
+                const auto indexed_target = indexed_nodes[target];
+                for (std::size_t j = 0; j < plain_nodes.size(); j++)
+                    if (plain_nodes[j] == plain_target.right_sibling())
+                    {
+                        plain_nodes.erase(plain_nodes.begin() + static_cast<std::ptrdiff_t>(j));
+                        indexed_nodes.erase(indexed_nodes.begin() + static_cast<std::ptrdiff_t>(j));
+                        break;
+                    }
+
+                plain.delete_right_sibling(plain_target);
+                indexed.delete_right_sibling(indexed_target);
+            }
+            else
+            {
+                plain_nodes.push_back(plain.insert_left_child(plain_nodes[target], i));
+                indexed_nodes.push_back(indexed.insert_left_child(indexed_nodes[target], i));
+            }
+
+            const unsigned probe = next_random(static_cast<unsigned>(plain_nodes.size()));
+            const std::size_t count = plain_nodes[probe].children_count();
+            REQUIRE_EQ(indexed_nodes[probe].children_count(), count);
+            for (std::size_t c = 0; c <= count; c++)
+            {
+                auto plain_child = plain_nodes[probe].child(c);
+                auto indexed_child = indexed_nodes[probe].child(c);
+                REQUIRE_EQ(plain_child.is_null(), indexed_child.is_null());
+                if (!plain_child.is_null())
+                    REQUIRE_EQ(plain_child.data(), indexed_child.data());
+            }
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    // refuses to be built from a negative number
+    struct picky
+    {
+        int value;
+
+        picky(int v) : value(v)
+        {
+            if (v < 0)
+                throw std::runtime_error("negative");
+        }
+    };
+
+    template <typename Node>
+    std::vector<int> children_of(Node n)
+    {
+        std::vector<int> values;
+        for (auto child = n.left_child(); !child.is_null(); child = child.right_sibling())
+            values.push_back(child.data());
+        return values;
+    }
+}
+
+TEST_CASE("insert children")
+{
+    SUBCASE("appends after the last child")
+    {
+        general_tree<int> gt(0);
+        gt.insert_last_child(gt.root(), 1);
+
+        const std::vector<int> values{2, 3, 4};
+        auto inserted = gt.insert_last_children(gt.root(), values.begin(), values.end());
+
+        std::vector<int> expected{1, 2, 3, 4};
+        REQUIRE_EQ(children_of(gt.root()), expected);
+        REQUIRE_EQ(gt.root().last_child().data(), 4);
+
+        std::vector<int> handles;
+        for (auto n : inserted)
+        {
+            REQUIRE_EQ(n.parent(), gt.root());
+            handles.push_back(n.data());
+        }
+        REQUIRE_EQ(handles, values);
+
+        gt.insert_last_child(gt.root(), 5);
+        REQUIRE_EQ(gt.root().last_child().data(), 5);
+    }
+
+    SUBCASE("prepends before the first child")
+    {
+        general_tree<int> gt(0);
+        gt.insert_last_child(gt.root(), 3);
+
+        auto inserted = gt.emplace_left_children(gt.root(), std::list<int>{1, 2});
+        std::vector<int> expected{1, 2, 3};
+        REQUIRE_EQ(children_of(gt.root()), expected);
+        REQUIRE_EQ((*inserted.begin()).data(), 1);
+
+        auto leaf = gt.root().left_child();
+        gt.emplace_left_children(leaf, std::vector<int>{7, 8});
+        REQUIRE_EQ(leaf.last_child().data(), 8);
+    }
+
+    SUBCASE("empty ranges and null nodes")
+    {
+        general_tree<int> gt(0);
+        REQUIRE(gt.emplace_last_children(gt.root(), std::vector<int>{}).empty());
+        REQUIRE(gt.root().is_leaf());
+
+        const std::vector<int> values{1};
+        REQUIRE_THROWS_AS(gt.emplace_last_children(general_tree<int>::node(), values), std::invalid_argument);
+        REQUIRE_THROWS_AS(gt.insert_left_children(general_tree<int>::node(), values.begin(), values.end()),
+                          std::invalid_argument);
+    }
+
+    SUBCASE("maintains the bookkeeping of every feature")
+    {
+        using full_tree = general_tree<int, std::allocator<int>,
+                                       tree_feature::indexed_children | tree_feature::left_sibling_links |
+                                           tree_feature::subtree_sizes | tree_feature::cached_depth |
+                                           tree_feature::structural_hash>;
+
+        full_tree gt(0);
+        auto a = gt.insert_last_child(gt.root(), 1);
+        gt.insert_last_child(a, 10);
+        gt.emplace_left_children(a, std::vector<int>{8, 9});
+        gt.emplace_last_children(a, std::vector<int>{11, 12});
+
+        REQUIRE_EQ(gt.root().descendants_count(), 6);
+        REQUIRE_EQ(a.children_count(), 5);
+        REQUIRE_EQ(a.child(3).data(), 11);
+        REQUIRE_EQ(a.child(2).left_sibling().data(), 9);
+        REQUIRE_EQ(a.last_child().depth(), 2);
+
+        full_tree expected(0);
+        auto b = expected.insert_last_child(expected.root(), 1);
+        for (int value : {8, 9, 10, 11, 12})
+            expected.insert_last_child(b, value);
+        REQUIRE_EQ(gt.root().subtree_hash(), expected.root().subtree_hash());
+        REQUIRE(gt == expected);
+    }
+
+    SUBCASE("nothing is inserted when a constructor throws")
+    {
+        general_tree<picky> gt(picky(0));
+        gt.emplace_last_child(gt.root(), 1);
+        REQUIRE_THROWS_AS(gt.emplace_last_children(gt.root(), std::vector<int>{2, 3, -1, 4}), std::runtime_error);
+        REQUIRE_EQ(gt.root().children_count(), 1);
+        REQUIRE_EQ(gt.root().last_child().data().value, 1);
+    }
+}
@@ -0,0 +1,162 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <stdexcept>
+#include <utility>
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "insert_last_child")
+{
+    SUBCASE("make one copy of the provided value and insert it as last child")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(3);
+        LifecycleCounter value("string1", 1);
+        gt.insert_last_child(gt.root(), value);
+        CHECK_EQ(LifecycleCounter::copy_constructor_calls, 1);
+        CHECK_EQ(gt.root().last_child().data(), value);
+    }
+
+    SUBCASE("temporary value triggers move")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(1);
+        gt.insert_last_child(gt.root(), LifecycleCounter{});
+        CHECK_EQ(LifecycleCounter::copy_constructor_calls, 0);
+        CHECK_EQ(LifecycleCounter::move_constructor_calls, 1);
+    }
+
+    SUBCASE("children keep the insertion order")
+    {
+        general_tree<int> tree(0);
+        for (int i = 1; i <= 5; i++)
+            tree.insert_last_child(tree.root(), i);
+
+        for (std::size_t i = 0; i < 5; i++)
+            REQUIRE_EQ(tree.root().child(i).data(), static_cast<int>(i + 1));
+        REQUIRE_EQ(tree.root().last_child().data(), 5);
+        REQUIRE(tree.root().last_child().right_sibling().is_null());
+    }
+
+    SUBCASE("first inserted child is also the left child")
+    {
+        general_tree<int> tree(0);
+        auto node = tree.insert_last_child(tree.root(), 1);
+        REQUIRE_EQ(tree.root().left_child(), node);
+        REQUIRE_EQ(tree.root().last_child(), node);
+        REQUIRE_EQ(node.parent(), tree.root());
+    }
+
+    SUBCASE("throw invalid argument if destiny node is null")
+    {
+        general_tree<int> tree(1);
+        REQUIRE_THROWS_AS(tree.insert_last_child(tree.root().left_child(), 2), std::invalid_argument);
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "insert_last_child (emplacement)")
+{
+    SUBCASE("use the arguments to construct the value as the last child")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(1);
+        gt.emplace_left_child(gt.root(), "string1", 1);
+        gt.emplace_last_child(gt.root(), "string100", 100);
+
+        CHECK_EQ(gt.root().last_child().data().get_int(), 100);
+        CHECK_EQ(gt.root().child(1).data().get_int(), 100);
+        CHECK_EQ(LifecycleCounter::copy_constructor_calls, 0);
+        CHECK_EQ(LifecycleCounter::move_constructor_calls, 0);
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "insert_last_child (tree)")
+{
+    SUBCASE("inserted tree root is now the last child")
+    {
+        general_tree<int> tree(1);
+        tree.insert_left_child(tree.root(), 2);
+        general_tree<int> new_tree(3);
+        new_tree.insert_left_child(new_tree.root(), 4);
+        auto inserted_tree_root = new_tree.root();
+
+        auto node = tree.insert_last_child(tree.root(), new_tree);
+
+        REQUIRE_EQ(node, inserted_tree_root);
+        REQUIRE_EQ(tree.root().last_child(), inserted_tree_root);
+        REQUIRE_EQ(tree.root().child(1), inserted_tree_root);
+        REQUIRE_EQ(node.parent(), tree.root());
+        REQUIRE(new_tree.empty());
+    }
+
+    SUBCASE("return null node if inserted tree is empty")
+    {
+        general_tree<int> tree(1);
+        general_tree<int> empty_tree;
+        REQUIRE(tree.insert_last_child(tree.root(), empty_tree).is_null());
+    }
+
+    SUBCASE("throw invalid argument if tree is inserted to its own root")
+    {
+        general_tree<int> tree(1);
+        REQUIRE_THROWS_AS(tree.insert_last_child(tree.root(), tree), std::invalid_argument);
+    }
+}
+
+TEST_CASE("last child")
+{
+    SUBCASE("null when the node has no children")
+    {
+        general_tree<int> tree(1);
+        REQUIRE(tree.root().last_child().is_null());
+    }
+
+    SUBCASE("follows left child insertions")
+    {
+        general_tree<int> tree(1);
+        auto last = tree.insert_left_child(tree.root(), 2);
+        tree.insert_left_child(tree.root(), 3);
+        REQUIRE_EQ(tree.root().last_child(), last);
+    }
+
+    SUBCASE("follows right sibling insertions")
+    {
+        general_tree<int> tree(1);
+        auto first = tree.insert_left_child(tree.root(), 2);
+        auto last = tree.insert_right_sibling(first, 3);
+        tree.insert_right_sibling(first, 4);
+        REQUIRE_EQ(tree.root().last_child(), last);
+
+        general_tree<int> other(5);
+        auto inserted = tree.insert_right_sibling(last, other);
+        REQUIRE_EQ(tree.root().last_child(), inserted);
+    }
+
+    SUBCASE("follows deletions")
+    {
+        general_tree<int> tree(1);
+        auto first = tree.insert_last_child(tree.root(), 2);
+        auto second = tree.insert_last_child(tree.root(), 3);
+        tree.insert_last_child(tree.root(), 4);
+
+        tree.delete_right_sibling(second);
+        REQUIRE_EQ(tree.root().last_child(), second);
+
+        tree.delete_right_sibling(first);
+        REQUIRE_EQ(tree.root().last_child(), first);
+
+        tree.delete_left_child(tree.root());
+        REQUIRE(tree.root().last_child().is_null());
+
+        auto node = tree.insert_last_child(tree.root(), 5);
+        REQUIRE_EQ(tree.root().left_child(), node);
+    }
+
+    SUBCASE("copies keep the last child")
+    {
+        general_tree<int> tree(1);
+        tree.insert_last_child(tree.root(), 2);
+        tree.insert_last_child(tree.insert_last_child(tree.root(), 3), 4);
+
+        general_tree<int> copy(tree);
+        REQUIRE_EQ(copy.root().last_child().data(), 3);
+        REQUIRE_EQ(copy.root().last_child().last_child().data(), 4);
+    }
+}
@@ -0,0 +1,152 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include "utils/helpers/seed-tree.h"
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    // 1
+    // |-- 2
+    // |   |-- 5
+    // |   `-- 6
+    // |-- 3
+    // `-- 4
+    //     `-- 7
+    general_tree<int> sample_tree()
+    {
+        general_tree<int> gt(1);
+        auto n2 = gt.insert_left_child(gt.root(), 2);
+        auto n3 = gt.insert_right_sibling(n2, 3);
+        auto n4 = gt.insert_right_sibling(n3, 4);
+        gt.insert_right_sibling(gt.insert_left_child(n2, 5), 6);
+        gt.insert_left_child(n4, 7);
+        return gt;
+    }
+
+    template <typename Iterator>
+    std::vector<int> collect(Iterator first, Iterator last)
+    {
+        std::vector<int> values;
+        for (; first != last; ++first)
+            values.push_back(*first);
+        return values;
+    }
+}
+
+TEST_CASE("preorder iterator")
+{
+    SUBCASE("visit the nodes in pre-order")
+    {
+        auto gt = sample_tree();
+        const std::vector<int> expected{1, 2, 5, 6, 3, 4, 7};
+        REQUIRE_EQ(collect(gt.preorder_begin(), gt.preorder_end()), expected);
+    }
+
+    SUBCASE("begin equals end in an empty tree")
+    {
+        general_tree<int> gt;
+        REQUIRE(gt.preorder_begin() == gt.preorder_end());
+    }
+
+    SUBCASE("values can be modified through the iterator")
+    {
+        auto gt = sample_tree();
+        for (auto it = gt.preorder_begin(); it != gt.preorder_end(); ++it)
+            *it *= 10;
+        REQUIRE_EQ(gt.root().left_child().left_child().data(), 50);
+    }
+
+    SUBCASE("get_node returns the current node")
+    {
+        auto gt = sample_tree();
+        auto it = gt.preorder_begin();
+        ++it;
+        REQUIRE_EQ(it.get_node(), gt.root().left_child());
+    }
+
+    SUBCASE("const tree yields const iterators")
+    {
+        const auto gt = sample_tree();
+        general_tree<int>::const_preorder_iterator it = gt.preorder_begin();
+        REQUIRE_EQ(*it, 1);
+        REQUIRE_EQ(std::distance(gt.preorder_begin(), gt.preorder_end()), 7);
+    }
+}
+
+TEST_CASE("postorder iterator")
+{
+    SUBCASE("visit the nodes in post-order")
+    {
+        auto gt = sample_tree();
+        const std::vector<int> expected{5, 6, 2, 3, 7, 4, 1};
+        REQUIRE_EQ(collect(gt.postorder_begin(), gt.postorder_end()), expected);
+    }
+
+    SUBCASE("begin equals end in an empty tree")
+    {
+        general_tree<int> gt;
+        REQUIRE(gt.postorder_begin() == gt.postorder_end());
+    }
+
+    SUBCASE("single node tree")
+    {
+        general_tree<int> gt(1);
+        const std::vector<int> expected{1};
+        REQUIRE_EQ(collect(gt.postorder_begin(), gt.postorder_end()), expected);
+    }
+}
+
+TEST_CASE("bfs iterator")
+{
+    SUBCASE("visit the nodes level by level")
+    {
+        auto gt = sample_tree();
+        const std::vector<int> expected{1, 2, 3, 4, 5, 6, 7};
+        REQUIRE_EQ(collect(gt.bfs_begin(), gt.bfs_end()), expected);
+    }
+
+    SUBCASE("begin equals end in an empty tree")
+    {
+        general_tree<int> gt;
+        REQUIRE(gt.bfs_begin() == gt.bfs_end());
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "node::subtree()")
+{
+    SUBCASE("visit only the nodes hanging from the node")
+    {
+        auto gt = sample_tree();
+        std::vector<int> values;
+        for (int value : gt.root().left_child().subtree())
+            values.push_back(value);
+        const std::vector<int> expected{2, 5, 6};
+        REQUIRE_EQ(values, expected);
+    }
+
+    SUBCASE("range of a leaf contains only the leaf")
+    {
+        auto gt = sample_tree();
+        auto range = gt.root().child(2).left_child().subtree();
+        const std::vector<int> expected{7};
+        REQUIRE_EQ(collect(range.begin(), range.end()), expected);
+    }
+
+    SUBCASE("does not copy the values")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(20);
+        std::size_t count = 0;
+        for (const LifecycleCounter& value : gt.root().subtree())
+            count += value.get_int() >= 0;
+        REQUIRE_EQ(count, 20);
+        REQUIRE_EQ(LifecycleCounter::copy_constructor_calls, 0);
+    }
+
+    SUBCASE("throw invalid argument if node is null")
+    {
+        general_tree<int> gt;
+        REQUIRE_THROWS_AS(gt.root().subtree(), std::invalid_argument);
+    }
+}
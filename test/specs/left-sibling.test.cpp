@@ -0,0 +1,103 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <memory>
+#include <vector>
+
+using linked_tree = general_tree<int, std::allocator<int>, tree_feature::left_sibling_links>;
+
+namespace
+{
+    template <typename Tree>
+    void check_left_siblings(typename Tree::node parent)
+    {
+        typename Tree::node previous;
+        for (auto child = parent.left_child(); !child.is_null(); child = child.right_sibling())
+        {
+            REQUIRE_EQ(child.left_sibling(), previous);
+            previous = child;
+        }
+        REQUIRE_EQ(parent.last_child(), previous);
+    }
+}
+
+TEST_CASE("left sibling")
+{
+    SUBCASE("null for the root and for first children")
+    {
+        general_tree<int> gt(1);
+        auto child = gt.insert_left_child(gt.root(), 2);
+        REQUIRE(gt.root().left_sibling().is_null());
+        REQUIRE(child.left_sibling().is_null());
+    }
+
+    SUBCASE("return the previous sibling")
+    {
+        general_tree<int> gt(1);
+        auto first = gt.insert_left_child(gt.root(), 2);
+        auto second = gt.insert_right_sibling(first, 3);
+        REQUIRE_EQ(second.left_sibling(), first);
+    }
+}
+
+TEST_CASE("left sibling links")
+{
+    SUBCASE("follow every kind of insertion")
+    {
+        linked_tree gt(0);
+        auto a = gt.insert_left_child(gt.root(), 1);
+        gt.insert_left_child(gt.root(), 2);
+        gt.insert_right_sibling(a, 3);
+        gt.insert_last_child(gt.root(), 4);
+        linked_tree other(5);
+        gt.insert_right_sibling(a, other);
+        linked_tree other2(6);
+        gt.insert_left_child(gt.root(), other2);
+
+        check_left_siblings<linked_tree>(gt.root());
+        REQUIRE_EQ(gt.root().children_count(), 6);
+    }
+
+    SUBCASE("follow deletions")
+    {
+        linked_tree gt(0);
+        std::vector<linked_tree::node> children;
+        for (int i = 1; i <= 6; i++)
+            children.push_back(gt.insert_last_child(gt.root(), i));
+
+        gt.delete_node(children[2]);
+        check_left_siblings<linked_tree>(gt.root());
+        gt.delete_node(children[5]);
+        check_left_siblings<linked_tree>(gt.root());
+        gt.delete_left_child(gt.root());
+        check_left_siblings<linked_tree>(gt.root());
+        gt.delete_right_sibling(children[1]);
+        check_left_siblings<linked_tree>(gt.root());
+
+        REQUIRE_EQ(gt.root().children_count(), 2);
+        REQUIRE_EQ(gt.root().child(1).left_sibling(), children[1]);
+    }
+
+    SUBCASE("copies keep the links")
+    {
+        linked_tree gt(0);
+        for (int i = 1; i <= 4; i++)
+            gt.insert_last_child(gt.root(), i);
+
+        linked_tree copy(gt);
+        check_left_siblings<linked_tree>(copy.root());
+        REQUIRE_EQ(copy.root().last_child().left_sibling().data(), 3);
+    }
+
+    SUBCASE("deleting every child from the back")
+    {
+        linked_tree gt(0);
+        for (int i = 0; i < 1000; i++)
+            gt.insert_last_child(gt.root(), i);
+
+        while (gt.root().has_left_child())
+            gt.delete_node(gt.root().last_child());
+
+        REQUIRE(gt.root().is_leaf());
+        REQUIRE(gt.root().last_child().is_null());
+    }
+}
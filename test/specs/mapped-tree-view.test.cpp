@@ -0,0 +1,135 @@
+#include "doctest.h"
+#include "mapped-tree-view.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct point
+    {
+        double x;
+        std::int16_t y;
+
+        bool operator==(const point&) const = default;
+    };
+
+    // removes the file once the test is done with it
+    struct temporary_file
+    {
+        std::string path;
+
+        explicit temporary_file(const std::string& name)
+            : path((std::filesystem::temp_directory_path() / name).string())
+        {
+        }
+
+        ~temporary_file()
+        {
+            std::filesystem::remove(path);
+        }
+    };
+
+    template <typename Tree>
+    void write(const Tree& tree, const std::string& path)
+    {
+        std::ofstream out(path, std::ios::binary);
+        write_mapped_tree(tree, out);
+    }
+
+    // 1
+    // |-- 2
+    // |   |-- 5
+    // |   `-- 6
+    // |-- 3
+    // `-- 4
+    //     `-- 7
+    general_tree<int> sample_tree()
+    {
+        general_tree<int> gt(1);
+        auto n2 = gt.insert_last_child(gt.root(), 2);
+        gt.insert_last_child(n2, 5);
+        gt.insert_last_child(n2, 6);
+        gt.insert_last_child(gt.root(), 3);
+        auto n4 = gt.insert_last_child(gt.root(), 4);
+        gt.insert_last_child(n4, 7);
+        return gt;
+    }
+}
+
+TEST_CASE("mapped tree view")
+{
+    SUBCASE("navigates the mapped tree")
+    {
+        temporary_file file("general-tree-mapped-int.bin");
+        write(sample_tree(), file.path);
+
+        mapped_tree_view<int> view(file.path);
+        REQUIRE_EQ(view.size(), 7);
+        REQUIRE_EQ(view.root().data(), 1);
+        REQUIRE_EQ(view.root().children_count(), 3);
+
+        auto n4 = view.root().child(2);
+        REQUIRE_EQ(n4.data(), 4);
+        REQUIRE_EQ(n4.left_child().data(), 7);
+        REQUIRE_EQ(n4.left_child().depth(), 2);
+        REQUIRE_EQ(n4.parent(), view.root());
+        REQUIRE_FALSE(n4.has_right_sibling());
+        REQUIRE_EQ(view.root().left_child().right_sibling().data(), 3);
+        REQUIRE_EQ(view.root().descendants_count(), 6);
+
+        std::vector<int> expected{1, 2, 5, 6, 3, 4, 7};
+        std::vector<int> values(view.values().begin(), view.values().end());
+        REQUIRE_EQ(values, expected);
+    }
+
+    SUBCASE("values needing padding")
+    {
+        temporary_file file("general-tree-mapped-point.bin");
+        general_tree<point> gt(point{1.5, 1});
+        gt.insert_last_child(gt.root(), point{2.5, 2});
+        gt.insert_last_child(gt.root(), point{3.5, 3});
+        write(gt, file.path);
+
+        mapped_tree_view<point> view(file.path);
+        const point third{3.5, 3};
+        const point second{2.5, 2};
+        REQUIRE_EQ(view.root().child(1).data(), third);
+        REQUIRE_EQ(view.at(1).data(), second);
+    }
+
+    SUBCASE("empty tree and moves")
+    {
+        temporary_file file("general-tree-mapped-empty.bin");
+        write(general_tree<int>(), file.path);
+
+        mapped_tree_view<int> view(file.path);
+        REQUIRE(view.empty());
+        REQUIRE(view.root().is_null());
+
+        temporary_file other("general-tree-mapped-moved.bin");
+        write(sample_tree(), other.path);
+        view = mapped_tree_view<int>(other.path);
+        mapped_tree_view<int> moved(std::move(view));
+        REQUIRE(view.empty());
+        REQUIRE_EQ(moved.size(), 7);
+    }
+
+    SUBCASE("rejects unsuitable files")
+    {
+        REQUIRE_THROWS_AS(mapped_tree_view<int>("/nonexistent/general-tree.bin"), std::runtime_error);
+
+        temporary_file file("general-tree-mapped-type.bin");
+        write(sample_tree(), file.path);
+        REQUIRE_THROWS_AS(mapped_tree_view<double>(file.path), std::runtime_error);
+
+        std::filesystem::resize_file(file.path, 40);
+        REQUIRE_THROWS_AS(mapped_tree_view<int>(file.path), std::runtime_error);
+
+        std::ofstream(file.path) << "not a tree";
+        REQUIRE_THROWS_AS(mapped_tree_view<int>(file.path), std::runtime_error);
+    }
+}
@@ -2,6 +2,7 @@
 #include "general-tree.h"
 #include "utils/fixtures/lifecycle-counter.fixture.h"
 #include "utils/helpers/seed-tree.h"
+#include <utility>
 
 TEST_CASE_FIXTURE(LifecycleCounterFixture, "assigment operator")
 {
@@ -67,6 +68,103 @@ TEST_CASE_FIXTURE(LifecycleCounterFixture, "assigment operator")
     }
 }
 
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "move assignment operator")
+{
+    SUBCASE("do not trigger any T's constructor")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(10);
+        general_tree<LifecycleCounter> gt2(LifecycleCounter("string1", 1));
+        LifecycleCounter::reset();
+
+        gt2 = std::move(gt);
+
+        CHECK_EQ(LifecycleCounter::copy_constructor_calls, 0);
+        CHECK_EQ(LifecycleCounter::move_constructor_calls, 0);
+        CHECK_EQ(LifecycleCounter::parameterized_constructor_calls, 0);
+    }
+
+    SUBCASE("assigning a temporary does not copy")
+    {
+        general_tree<LifecycleCounter> gt;
+        gt = seed_tree(10);
+        CHECK_EQ(LifecycleCounter::copy_constructor_calls, 0);
+        CHECK_EQ(gt.root().descendants_count(), 9);
+    }
+
+    SUBCASE("previous elements should be destroyed")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(4);
+        general_tree<LifecycleCounter> gt2 = seed_tree(7);
+
+        gt2 = std::move(gt);
+
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 7);
+    }
+
+    SUBCASE("other tree is empty and node handles remain valid")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(5);
+        auto backup = gt;
+        auto root = gt.root();
+        general_tree<LifecycleCounter> gt2;
+
+        gt2 = std::move(gt);
+
+        REQUIRE(gt.empty());
+        REQUIRE_EQ(gt2.root(), root);
+        REQUIRE_EQ(gt2, backup);
+    }
+
+    SUBCASE("no error in self-assigning")
+    {
+        general_tree<int> gt(1);
+        auto& self = gt;
+        gt = std::move(self);
+        REQUIRE_EQ(gt.root().data(), 1);
+    }
+
+    SUBCASE("moved-from tree can be reused normally afterwards")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(3);
+        general_tree<LifecycleCounter> gt2;
+        gt2 = std::move(gt);
+
+        gt.emplace_root("string", 0);
+        gt.emplace_left_child(gt.root(), "string1", 1);
+        gt.clear();
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 2);
+    }
+}
+
+TEST_CASE_FIXTURE(LifecycleCounterFixture, "swap")
+{
+    SUBCASE("exchange the nodes of both trees without copies")
+    {
+        general_tree<LifecycleCounter> gt = seed_tree(3);
+        general_tree<LifecycleCounter> gt2 = seed_tree(6);
+        auto root = gt.root();
+        auto root2 = gt2.root();
+
+        swap(gt, gt2);
+
+        REQUIRE_EQ(gt.root(), root2);
+        REQUIRE_EQ(gt2.root(), root);
+        REQUIRE_EQ(gt.root().descendants_count(), 5);
+        REQUIRE_EQ(LifecycleCounter::copy_constructor_calls, 0);
+        REQUIRE_EQ(LifecycleCounter::move_constructor_calls, 0);
+        REQUIRE_EQ(LifecycleCounter::destructor_calls, 0);
+    }
+
+    SUBCASE("swap with an empty tree")
+    {
+        general_tree<int> gt(1);
+        general_tree<int> empty;
+        gt.swap(empty);
+        REQUIRE(gt.empty());
+        REQUIRE_EQ(empty.root().data(), 1);
+    }
+}
+
 TEST_CASE_FIXTURE(LifecycleCounterFixture, "equality operator")
 {
     SUBCASE("return true if tree is the same tree")
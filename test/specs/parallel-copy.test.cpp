@@ -0,0 +1,165 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include "work-stealing-pool.h"
+#include <atomic>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    // copying throws once the given number of copies has been made
+    struct ThrowingCopy
+    {
+        static inline std::atomic<int> copies_left;
+        static inline std::atomic<int> alive;
+        int value;
+
+        ThrowingCopy(int v) : value(v)
+        {
+            ++alive;
+        }
+
+        ThrowingCopy(const ThrowingCopy& rhs) : value(rhs.value)
+        {
+            if (copies_left.fetch_sub(1) <= 0)
+                throw std::runtime_error("copy failed");
+            ++alive;
+        }
+
+        ~ThrowingCopy()
+        {
+            --alive;
+        }
+
+        bool operator==(const ThrowingCopy&) const = default;
+    };
+
+    template <typename Tree>
+    Tree random_tree(int size, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        Tree gt(0);
+        std::vector<typename Tree::node> nodes{gt.root()};
+        for (int i = 1; i < size; i++)
+            nodes.push_back(gt.insert_last_child(nodes[rng() % nodes.size()], i));
+        return gt;
+    }
+
+    template <typename Tree>
+    void check_parents(typename Tree::node n)
+    {
+        for (auto child = n.left_child(); !child.is_null(); child = child.right_sibling())
+        {
+            REQUIRE_EQ(child.parent(), n);
+            check_parents<Tree>(child);
+        }
+    }
+}
+
+TEST_CASE("parallel copy")
+{
+    work_stealing_pool executor(4);
+
+    SUBCASE("empty tree")
+    {
+        general_tree<int> gt;
+        auto copy = gt.parallel_copy(executor);
+        REQUIRE(copy.empty());
+    }
+
+    SUBCASE("equal to the original")
+    {
+        auto gt = random_tree<general_tree<int>>(5000, 3);
+        auto copy = gt.parallel_copy(executor);
+        REQUIRE(copy == gt);
+        REQUIRE_NE(copy.root(), gt.root());
+        check_parents<general_tree<int>>(copy.root());
+    }
+
+    SUBCASE("wide tree")
+    {
+        general_tree<int> gt(0);
+        for (int i = 1; i <= 200; i++)
+        {
+            auto child = gt.insert_last_child(gt.root(), i);
+            for (int j = 0; j < 20; j++)
+                gt.insert_last_child(child, j);
+        }
+
+        auto copy = gt.parallel_copy(executor);
+        REQUIRE(copy == gt);
+        REQUIRE_EQ(copy.root().children_count(), 200);
+    }
+
+    SUBCASE("keeps the optional bookkeeping")
+    {
+        constexpr tree_feature features = tree_feature::indexed_children | tree_feature::left_sibling_links |
+                                          tree_feature::subtree_sizes | tree_feature::cached_depth;
+        using tree = general_tree<int, std::allocator<int>, features>;
+
+        auto gt = random_tree<tree>(2000, 5);
+        auto copy = gt.parallel_copy(executor);
+        REQUIRE(copy == gt);
+        REQUIRE_EQ(copy.root().descendants_count(), 1999);
+
+        auto last = copy.root().last_child();
+        REQUIRE_EQ(last.left_sibling().right_sibling(), last);
+        REQUIRE_EQ(last.depth(), 1);
+        REQUIRE_EQ(copy.root().child(1), copy.root().left_child().right_sibling());
+    }
+
+    SUBCASE("failure releases the copied values")
+    {
+        {
+            general_tree<ThrowingCopy> gt(0);
+            for (int i = 1; i < 1000; i++)
+                gt.insert_last_child(gt.root(), i);
+
+            const int alive = ThrowingCopy::alive;
+            ThrowingCopy::copies_left = 500;
+            REQUIRE_THROWS_AS((void)gt.parallel_copy(executor), std::runtime_error);
+            REQUIRE_EQ(ThrowingCopy::alive.load(), alive);
+
+            ThrowingCopy::copies_left = 1000;
+            REQUIRE(gt.parallel_copy(executor) == gt);
+        }
+        REQUIRE_EQ(ThrowingCopy::alive.load(), 0);
+    }
+}
+
+TEST_CASE("work stealing pool")
+{
+    SUBCASE("runs every spawned task")
+    {
+        work_stealing_pool executor(3);
+        REQUIRE_EQ(executor.concurrency(), 3);
+
+        std::atomic<int> count = 0;
+        executor.run([&](work_stealing_pool::worker& w) {
+            for (int i = 0; i < 100; i++)
+            {
+                w.spawn([&](work_stealing_pool::worker& inner) {
+                    REQUIRE(inner.index() < 3);
+                    inner.spawn([&](work_stealing_pool::worker&) { ++count; });
+                    ++count;
+                });
+            }
+        });
+        REQUIRE_EQ(count.load(), 200);
+    }
+
+    SUBCASE("rethrows the first failure")
+    {
+        work_stealing_pool executor(2);
+        auto fail = [](work_stealing_pool::worker& w) {
+            w.spawn([](work_stealing_pool::worker&) { throw std::runtime_error("task failed"); });
+        };
+        REQUIRE_THROWS_AS(executor.run(fail), std::runtime_error);
+
+        int runs = 0;
+        executor.run([&](work_stealing_pool::worker&) { ++runs; });
+        REQUIRE_EQ(runs, 1);
+    }
+}
@@ -0,0 +1,107 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include "work-stealing-pool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    template <typename Tree>
+    Tree build(const char* shape, int size)
+    {
+        std::mt19937 rng(5);
+        Tree gt(0);
+        std::vector<typename Tree::node> nodes{gt.root()};
+        for (int i = 1; i < size; i++)
+        {
+            typename Tree::node parent = gt.root();
+            if (shape[0] == 'c')
+                parent = nodes.back();
+            else if (shape[0] == 'r')
+                parent = nodes[rng() % nodes.size()];
+            nodes.push_back(gt.insert_last_child(parent, i));
+        }
+        return gt;
+    }
+
+    // every node is visited exactly once
+    template <typename Tree>
+    void check_visits(const Tree& gt, int size, work_stealing_pool& pool)
+    {
+        std::vector<std::atomic<int>> visits(size);
+        gt.parallel_for_each(pool, [&](typename Tree::node n) { ++visits[n.data()]; });
+        for (const auto& count : visits)
+            REQUIRE_EQ(count.load(), 1);
+    }
+}
+
+TEST_CASE("parallel for each")
+{
+    work_stealing_pool pool(4);
+
+    SUBCASE("visits every node once whatever the shape")
+    {
+        for (const char* shape : {"random", "chain", "fan"})
+        {
+            check_visits(build<general_tree<int>>(shape, 5000), 5000, pool);
+
+            using sized_tree = general_tree<int, std::allocator<int>, tree_feature::subtree_sizes>;
+            check_visits(build<sized_tree>(shape, 5000), 5000, pool);
+        }
+    }
+
+    SUBCASE("a deep chain is shared between workers")
+    {
+        auto gt = build<general_tree<int>>("chain", 400);
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        gt.parallel_for_each(pool, [&](general_tree<int>::node) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        });
+        REQUIRE_GT(threads.size(), 1);
+    }
+
+    SUBCASE("subtrees and values")
+    {
+        auto gt = build<general_tree<int>>("random", 1000);
+        auto subtree = gt.root().left_child();
+        std::atomic<int> visited{0};
+        gt.parallel_for_each(subtree, pool, [&](general_tree<int>::node n) {
+            n.data() = -1;
+            ++visited;
+        });
+
+        int negated = 0;
+        for (auto it = gt.preorder_begin(); it != gt.preorder_end(); ++it)
+            negated += *it == -1;
+        REQUIRE_EQ(visited.load(), static_cast<int>(subtree.descendants_count() + 1));
+        REQUIRE_EQ(negated, visited.load());
+    }
+
+    SUBCASE("errors")
+    {
+        auto gt = build<general_tree<int>>("random", 1000);
+        REQUIRE_THROWS_AS(gt.parallel_for_each(pool,
+                                               [](general_tree<int>::node n) {
+                                                   if (n.data() == 500)
+                                                       throw std::runtime_error("failed");
+                                               }),
+                          std::runtime_error);
+        REQUIRE_THROWS_AS(gt.parallel_for_each(general_tree<int>::node(), pool, [](general_tree<int>::node) {}),
+                          std::invalid_argument);
+
+        general_tree<int> empty;
+        std::atomic<int> visited{0};
+        empty.parallel_for_each(pool, [&](general_tree<int>::node) { ++visited; });
+        REQUIRE_EQ(visited.load(), 0);
+    }
+}
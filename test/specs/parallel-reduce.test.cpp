@@ -0,0 +1,123 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include "work-stealing-pool.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    general_tree<int> build(const char* shape, int size)
+    {
+        std::mt19937 rng(11);
+        general_tree<int> gt(0);
+        std::vector<general_tree<int>::node> nodes{gt.root()};
+        for (int i = 1; i < size; i++)
+        {
+            auto parent = gt.root();
+            if (shape[0] == 'c')
+                parent = nodes.back();
+            else if (shape[0] == 'r')
+                parent = nodes[rng() % nodes.size()];
+            nodes.push_back(gt.insert_last_child(parent, i));
+        }
+        return gt;
+    }
+
+    long long subtree_sum(general_tree<int>::node n)
+    {
+        long long sum = 0;
+        for (int value : n.subtree())
+            sum += value;
+        return sum;
+    }
+}
+
+TEST_CASE("parallel reduce")
+{
+    work_stealing_pool pool(4);
+    auto value = [](general_tree<int>::node n) { return static_cast<long long>(n.data()); };
+    auto add = [](long long lhs, long long rhs) { return lhs + rhs; };
+
+    SUBCASE("sums every shape")
+    {
+        for (const char* shape : {"random", "chain", "fan"})
+        {
+            auto gt = build(shape, 20000);
+            REQUIRE_EQ(gt.parallel_reduce(gt.root(), pool, value, add), 19999LL * 20000 / 2);
+        }
+    }
+
+    SUBCASE("children are combined in sibling order")
+    {
+        auto gt = build("random", 3000);
+        auto text = gt.parallel_reduce(
+            gt.root(), pool, [](general_tree<int>::node n) { return std::to_string(n.data()) + ","; },
+            [](std::string lhs, const std::string& rhs) { return lhs + rhs; });
+
+        std::string expected;
+        for (auto it = gt.preorder_begin(); it != gt.preorder_end(); ++it)
+            expected += std::to_string(*it) + ",";
+        REQUIRE_EQ(text, expected);
+    }
+
+    SUBCASE("results of every node")
+    {
+        auto gt = build("random", 2000);
+        auto subtree = gt.root().left_child();
+        std::vector<long long> results;
+        REQUIRE_EQ(gt.parallel_reduce(subtree, pool, value, add, results), subtree_sum(subtree));
+        REQUIRE_EQ(results.size(), subtree.descendants_count() + 1);
+
+        std::vector<general_tree<int>::node> preorder;
+        for (auto it = subtree.subtree().begin(); it != subtree.subtree().end(); ++it)
+            preorder.push_back(it.get_node());
+        for (std::size_t i = 0; i < preorder.size(); i++)
+            REQUIRE_EQ(results[i], subtree_sum(preorder[i]));
+
+        std::size_t deepest = 0;
+        for (auto n : preorder)
+            deepest = std::max(deepest, n.depth());
+        auto height = gt.parallel_reduce(
+            subtree, pool, [](general_tree<int>::node) { return std::size_t(0); },
+            [](std::size_t height, std::size_t child) { return std::max(height, child + 1); });
+        REQUIRE_EQ(height, deepest - 1);
+    }
+
+    SUBCASE("boolean results")
+    {
+        // std::vector<bool> packs its elements, the results of distinct nodes must not share storage
+        auto gt = build("random", 20000);
+        auto is_even = [](general_tree<int>::node n) { return n.data() % 2 == 0; };
+        auto all = [](bool lhs, bool rhs) { return lhs && rhs; };
+        REQUIRE_FALSE(gt.parallel_reduce(gt.root(), pool, is_even, all));
+
+        std::vector<bool> results;
+        gt.parallel_reduce(gt.root(), pool, is_even, all, results);
+        REQUIRE_EQ(results.size(), 20000);
+
+        // a leaf reduces to its own value
+        std::size_t position = 0;
+        for (auto it = gt.preorder_begin(); it != gt.preorder_end(); ++it, ++position)
+        {
+            if (it.get_node().is_leaf())
+                REQUIRE_EQ(results[position], *it % 2 == 0);
+        }
+    }
+
+    SUBCASE("errors")
+    {
+        auto gt = build("random", 2000);
+        REQUIRE_THROWS_AS(gt.parallel_reduce(gt.root(), pool,
+                                             [](general_tree<int>::node n) {
+                                                 if (n.data() == 1000)
+                                                     throw std::runtime_error("failed");
+                                                 return 0;
+                                             },
+                                             add),
+                          std::runtime_error);
+        REQUIRE_THROWS_AS(gt.parallel_reduce(general_tree<int>::node(), pool, value, add), std::invalid_argument);
+    }
+}
@@ -0,0 +1,157 @@
+#include "doctest.h"
+#include "persistent-general-tree.h"
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using tree = persistent_general_tree<int>;
+
+namespace
+{
+    std::vector<int> preorder(const tree& t)
+    {
+        std::vector<int> values;
+        if (t.empty())
+            return values;
+
+        std::vector<tree::node> pending{t.root()};
+        while (!pending.empty())
+        {
+            tree::node n = pending.back();
+            pending.pop_back();
+            values.push_back(n.data());
+            if (n.has_right_sibling() && !n.is_root())
+                pending.push_back(n.right_sibling());
+            if (n.has_left_child())
+                pending.push_back(n.left_child());
+        }
+        return values;
+    }
+
+    // 1
+    // |-- 2
+    // |   `-- 4
+    // `-- 3
+    tree sample_tree()
+    {
+        tree t(1);
+        t = t.emplace_left_child(t.root(), 3);
+        t = t.emplace_left_child(t.root(), 2);
+        t = t.emplace_left_child(t.root().left_child(), 4);
+        return t;
+    }
+}
+
+TEST_CASE("persistent general tree")
+{
+    SUBCASE("empty tree")
+    {
+        tree t;
+        REQUIRE(t.empty());
+        REQUIRE(t.root().is_null());
+    }
+
+    SUBCASE("insertions return new versions")
+    {
+        tree v1(1);
+        tree v2 = v1.insert_left_child(v1.root(), 2);
+        tree v3 = v2.insert_right_sibling(v2.root().left_child(), 3);
+
+        std::vector<int> expected1{1};
+        std::vector<int> expected2{1, 2};
+        std::vector<int> expected3{1, 2, 3};
+        REQUIRE_EQ(preorder(v1), expected1);
+        REQUIRE_EQ(preorder(v2), expected2);
+        REQUIRE_EQ(preorder(v3), expected3);
+    }
+
+    SUBCASE("deletions return new versions")
+    {
+        tree t = sample_tree();
+        tree without_first = t.delete_left_child(t.root());
+        tree without_second = t.delete_right_sibling(t.root().left_child());
+
+        std::vector<int> expected{1, 2, 4, 3};
+        std::vector<int> expected_first{1, 3};
+        std::vector<int> expected_second{1, 2, 4};
+        REQUIRE_EQ(preorder(t), expected);
+        REQUIRE_EQ(preorder(without_first), expected_first);
+        REQUIRE_EQ(preorder(without_second), expected_second);
+        REQUIRE(t.delete_left_child(t.root().child(1)) == t);
+    }
+
+    SUBCASE("untouched subtrees are shared")
+    {
+        tree t = sample_tree();
+        tree updated = t.update_data(t.root().child(1), 30);
+
+        REQUIRE_EQ(updated.root().child(1).data(), 30);
+        REQUIRE_EQ(t.root().child(1).data(), 3);
+        // the first child is copied because it links to the updated node, its descendants are not
+        REQUIRE_NE(updated.root().left_child(), t.root().left_child());
+        REQUIRE_EQ(updated.root().left_child().left_child(), t.root().left_child().left_child());
+    }
+
+    SUBCASE("handles navigate back to the parent")
+    {
+        tree t = sample_tree();
+        auto n4 = t.root().left_child().left_child();
+        REQUIRE_EQ(n4.depth(), 2);
+        REQUIRE_EQ(n4.parent().data(), 2);
+        REQUIRE_EQ(n4.parent().right_sibling().parent(), t.root());
+        REQUIRE(t.root().parent().is_null());
+        REQUIRE_EQ(t.root().children_count(), 2);
+    }
+
+    SUBCASE("rejects handles of other versions")
+    {
+        tree t = sample_tree();
+        tree other = t.insert_left_child(t.root(), 9);
+        auto stale = t.root().left_child();
+
+        REQUIRE_THROWS_AS((void)other.insert_left_child(stale, 5), std::invalid_argument);
+        REQUIRE_THROWS_AS((void)t.insert_left_child(tree::node(), 5), std::invalid_argument);
+        REQUIRE_THROWS_AS((void)t.insert_right_sibling(t.root(), 5), std::invalid_argument);
+    }
+
+    SUBCASE("equality")
+    {
+        REQUIRE(sample_tree() == sample_tree());
+        tree t = sample_tree();
+        REQUIRE_FALSE(t == t.update_data(t.root().left_child().left_child(), 5));
+        REQUIRE_FALSE(t == tree());
+    }
+
+    SUBCASE("long chains are released without recursion")
+    {
+        tree t(0);
+        t = t.insert_left_child(t.root(), 1);
+        for (int i = 2; i < 1000000; i++)
+            t = t.insert_right_sibling(t.root().left_child(), i);
+
+        tree snapshot = t;
+        t = tree();
+        REQUIRE_EQ(snapshot.root().child(999998).data(), 2);
+    }
+
+    SUBCASE("versions sharing nodes are released from several threads")
+    {
+        // every thread drops its own versions, all of them sharing the same children of the root
+        tree base(0);
+        base = base.insert_left_child(base.root(), 1);
+        for (int i = 2; i < 2000; i++)
+            base = base.insert_right_sibling(base.root().left_child(), i);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++)
+        {
+            threads.emplace_back([version = base, t]() mutable {
+                for (int i = 0; i < 200; i++)
+                    version = version.update_data(version.root().child(static_cast<std::size_t>(i * 7 + t)), -i);
+            });
+        }
+        base = tree();
+        for (auto& thread : threads)
+            thread.join();
+    }
+}
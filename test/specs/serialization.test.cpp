@@ -0,0 +1,157 @@
+#include "doctest.h"
+#include "tree-serialization.h"
+#include "utils/fixtures/lifecycle-counter.fixture.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// values which are not trivially copyable need their own codec
+template <>
+struct tree_codec<LifecycleCounter>
+{
+    template <typename Writer>
+    static void encode(Writer& out, const LifecycleCounter& value)
+    {
+        tree_codec<std::string>::encode(out, value.get_string());
+        out.write_varint(static_cast<std::uint64_t>(value.get_int()));
+    }
+
+    template <typename Reader>
+    static LifecycleCounter decode(Reader& in)
+    {
+        std::string string = tree_codec<std::string>::decode(in);
+        return LifecycleCounter(string, static_cast<int>(in.read_varint()));
+    }
+};
+
+namespace
+{
+    general_tree<int> random_tree(int size)
+    {
+        std::mt19937 rng(13);
+        general_tree<int> gt(0);
+        std::vector<general_tree<int>::node> nodes{gt.root()};
+        for (int i = 1; i < size; i++)
+            nodes.push_back(gt.insert_last_child(nodes[rng() % nodes.size()], i * 7));
+        return gt;
+    }
+}
+
+TEST_CASE("serialization")
+{
+    SUBCASE("buffer round trip")
+    {
+        auto gt = random_tree(3000);
+        std::vector<std::byte> buffer;
+        serialize(gt, buffer);
+
+        auto copy = deserialize<general_tree<int>>(buffer);
+        REQUIRE(copy == gt);
+    }
+
+    SUBCASE("stream round trip")
+    {
+        auto gt = random_tree(3000);
+        std::stringstream stream;
+        serialize(gt, stream);
+
+        auto copy = deserialize<general_tree<int>>(stream);
+        REQUIRE(copy == gt);
+    }
+
+    SUBCASE("empty tree")
+    {
+        general_tree<int> gt;
+        std::vector<std::byte> buffer;
+        serialize(gt, buffer);
+        REQUIRE(deserialize<general_tree<int>>(buffer).empty());
+    }
+
+    SUBCASE("strings and custom codecs")
+    {
+        general_tree<std::string> strings("root");
+        auto child = strings.insert_left_child(strings.root(), std::string(300, 'x'));
+        strings.insert_left_child(child, "");
+        std::stringstream stream;
+        serialize(strings, stream);
+        REQUIRE(deserialize<general_tree<std::string>>(stream) == strings);
+
+        general_tree<LifecycleCounter> counters(LifecycleCounter("a", 1));
+        counters.insert_last_child(counters.root(), LifecycleCounter("b", 2));
+        counters.insert_last_child(counters.root(), LifecycleCounter("c", 300));
+        std::vector<std::byte> buffer;
+        serialize(counters, buffer);
+        REQUIRE(deserialize<general_tree<LifecycleCounter>>(buffer) == counters);
+    }
+
+    SUBCASE("bookkeeping of the features")
+    {
+        using full_tree = general_tree<int, std::allocator<int>,
+                                       tree_feature::indexed_children | tree_feature::subtree_sizes |
+                                           tree_feature::cached_depth | tree_feature::structural_hash>;
+        full_tree gt(0);
+        std::vector<full_tree::node> nodes{gt.root()};
+        std::mt19937 rng(5);
+        for (int i = 1; i < 2000; i++)
+            nodes.push_back(gt.insert_last_child(nodes[rng() % nodes.size()], i));
+
+        std::vector<std::byte> buffer;
+        serialize(gt, buffer);
+        auto copy = deserialize<full_tree>(buffer);
+        REQUIRE_EQ(copy.root().subtree_hash(), gt.root().subtree_hash());
+        REQUIRE_EQ(copy.root().descendants_count(), 1999);
+        REQUIRE_EQ(copy.root().child(0).depth(), 1);
+        REQUIRE(copy == gt);
+    }
+
+    SUBCASE("trees are read one after the other from a stream")
+    {
+        auto first = random_tree(50);
+        auto second = random_tree(80);
+        std::stringstream stream;
+        serialize(first, stream);
+        serialize(second, stream);
+
+        REQUIRE(deserialize<general_tree<int>>(stream) == first);
+        REQUIRE(deserialize<general_tree<int>>(stream) == second);
+    }
+
+    SUBCASE("rejects malformed data")
+    {
+        auto gt = random_tree(100);
+        std::vector<std::byte> buffer;
+        serialize(gt, buffer);
+
+        std::vector<std::byte> truncated(buffer.begin(), buffer.end() - 3);
+        REQUIRE_THROWS_AS(deserialize<general_tree<int>>(truncated), std::runtime_error);
+
+        buffer[0] = std::byte{'X'};
+        REQUIRE_THROWS_AS(deserialize<general_tree<int>>(buffer), std::runtime_error);
+
+        std::stringstream stream("GTR1");
+        REQUIRE_THROWS_AS(deserialize<general_tree<int>>(stream), std::runtime_error);
+        REQUIRE(stream.fail());
+    }
+
+    SUBCASE("rejects a string length beyond the data")
+    {
+        // a root without children whose value claims 2^62 bytes and has three
+        std::vector<std::byte> buffer;
+        tree_buffer_writer writer(buffer);
+        writer.write_bytes("GTR1", 4);
+        writer.write_varint(1);
+        writer.write_varint(0);
+        writer.write_varint(std::uint64_t(1) << 62);
+        writer.write_bytes("abc", 3);
+
+        REQUIRE_THROWS_AS(deserialize<general_tree<std::string>>(buffer), std::runtime_error);
+
+        std::stringstream stream(std::string(reinterpret_cast<const char*>(buffer.data()), buffer.size()));
+        REQUIRE_THROWS_AS(deserialize<general_tree<std::string>>(stream), std::runtime_error);
+    }
+}
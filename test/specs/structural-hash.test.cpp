@@ -0,0 +1,183 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using hashed_tree = general_tree<int, std::allocator<int>, tree_feature::structural_hash>;
+
+namespace
+{
+    // 1
+    // |-- 2
+    // |   |-- 4
+    // |   `-- 5
+    // `-- 3
+    hashed_tree sample_tree()
+    {
+        hashed_tree gt(1);
+        auto n2 = gt.insert_last_child(gt.root(), 2);
+        gt.insert_last_child(gt.root(), 3);
+        gt.insert_last_child(n2, 4);
+        gt.insert_last_child(n2, 5);
+        return gt;
+    }
+}
+
+TEST_CASE("structural hash")
+{
+    SUBCASE("equal for equal trees built in a different order")
+    {
+        hashed_tree gt(1);
+        auto n3 = gt.insert_left_child(gt.root(), 3);
+        auto n2 = gt.insert_left_child(gt.root(), 2);
+        gt.insert_left_child(n2, 5);
+        gt.insert_left_child(n2, 4);
+
+        REQUIRE_EQ(gt.root().subtree_hash(), sample_tree().root().subtree_hash());
+        REQUIRE_EQ(n3.subtree_hash(), hashed_tree(3).root().subtree_hash());
+        REQUIRE(gt == sample_tree());
+    }
+
+    SUBCASE("depends on sibling order and shape")
+    {
+        hashed_tree swapped(1);
+        auto n3 = swapped.insert_last_child(swapped.root(), 3);
+        auto n2 = swapped.insert_last_child(swapped.root(), 2);
+        swapped.insert_last_child(n2, 4);
+        swapped.insert_last_child(n2, 5);
+
+        hashed_tree reshaped(1);
+        auto r2 = reshaped.insert_last_child(reshaped.root(), 2);
+        reshaped.insert_last_child(r2, 4);
+        reshaped.insert_last_child(reshaped.root(), 5);
+        reshaped.insert_last_child(reshaped.root(), 3);
+
+        REQUIRE_NE(swapped.root().subtree_hash(), sample_tree().root().subtree_hash());
+        REQUIRE_NE(reshaped.root().subtree_hash(), sample_tree().root().subtree_hash());
+        REQUIRE_FALSE(swapped == sample_tree());
+        REQUIRE_FALSE(reshaped == sample_tree());
+        REQUIRE_NE(n3.subtree_hash(), n2.subtree_hash());
+    }
+
+    SUBCASE("follows insertions and deletions")
+    {
+        hashed_tree gt = sample_tree();
+        const std::size_t original = gt.root().subtree_hash();
+
+        auto added = gt.insert_right_sibling(gt.root().left_child(), 9);
+        REQUIRE_NE(gt.root().subtree_hash(), original);
+        gt.delete_node(added);
+        REQUIRE_EQ(gt.root().subtree_hash(), original);
+
+        hashed_tree other(7);
+        gt.insert_last_child(gt.root().left_child().left_child(), other);
+        REQUIRE_NE(gt.root().subtree_hash(), original);
+        gt.delete_left_child(gt.root().left_child().left_child());
+        REQUIRE_EQ(gt.root().subtree_hash(), original);
+    }
+
+    SUBCASE("follows updated values")
+    {
+        hashed_tree gt = sample_tree();
+        auto n5 = gt.root().left_child().last_child();
+        const std::size_t original = gt.root().subtree_hash();
+        const std::size_t sibling = gt.root().last_child().subtree_hash();
+
+        gt.update_data(n5, 50);
+        REQUIRE_EQ(n5.data(), 50);
+        REQUIRE_NE(gt.root().subtree_hash(), original);
+        REQUIRE_EQ(gt.root().last_child().subtree_hash(), sibling);
+
+        gt.update_data(n5, 5);
+        REQUIRE_EQ(gt.root().subtree_hash(), original);
+        REQUIRE_THROWS_AS(gt.update_data(hashed_tree::node(), 1), std::invalid_argument);
+    }
+
+    SUBCASE("equal for wide trees whatever end the children were added and removed from")
+    {
+        // 0 with the children 0 ... 999, each with the children 0 ... 2
+        std::vector<std::pair<std::size_t, int>> nodes{{0, 0}};
+        for (int i = 0; i < 1000; i++)
+        {
+            nodes.emplace_back(1, i);
+            for (int j = 0; j < 3; j++)
+                nodes.emplace_back(2, j);
+        }
+        const auto expected = hashed_tree::from_preorder_depths(nodes);
+
+        hashed_tree gt(0);
+        auto root = gt.root();
+        for (int i = 500; i < 1000; i++)
+            gt.insert_last_child(root, i);
+        for (int i = 499; i >= 0; i--)
+            gt.insert_left_child(root, i);
+        for (auto child = root.left_child(); !child.is_null(); child = child.right_sibling())
+        {
+            gt.insert_left_child(child, 1);
+            gt.insert_right_sibling(child.left_child(), 2);
+            gt.insert_left_child(child, 0);
+        }
+        REQUIRE_EQ(gt.root().subtree_hash(), expected.root().subtree_hash());
+
+        // a child taken out of the middle and put back, then one more at each end taken out again
+        auto middle = gt.root().child(499);
+        gt.delete_right_sibling(middle);
+        REQUIRE_NE(gt.root().subtree_hash(), expected.root().subtree_hash());
+        auto restored = gt.insert_right_sibling(middle, 500);
+        const std::vector<int> grandchildren{0, 1};
+        gt.insert_last_child(restored, 2);
+        gt.insert_left_children(restored, grandchildren.begin(), grandchildren.end());
+
+        gt.insert_left_child(root, -1);
+        gt.insert_last_child(root, 1000);
+        gt.delete_left_child(root);
+        gt.delete_node(root.last_child());
+        REQUIRE_EQ(gt.root().subtree_hash(), expected.root().subtree_hash());
+        REQUIRE(gt == expected);
+    }
+
+    SUBCASE("copies keep the hashes")
+    {
+        hashed_tree gt = sample_tree();
+        hashed_tree copy(gt);
+        REQUIRE_EQ(copy.root().subtree_hash(), gt.root().subtree_hash());
+        REQUIRE_EQ(copy.root().left_child().subtree_hash(), gt.root().left_child().subtree_hash());
+    }
+
+    SUBCASE("narrows down the changed region")
+    {
+        hashed_tree before = sample_tree();
+        hashed_tree after = sample_tree();
+        after.update_data(after.root().left_child().left_child(), 40);
+
+        auto lhs = before.root();
+        auto rhs = after.root();
+        while (!lhs.is_leaf())
+        {
+            auto lhs_child = lhs.left_child();
+            auto rhs_child = rhs.left_child();
+            while (lhs_child.subtree_hash() == rhs_child.subtree_hash())
+            {
+                lhs_child = lhs_child.right_sibling();
+                rhs_child = rhs_child.right_sibling();
+            }
+            lhs = lhs_child;
+            rhs = rhs_child;
+        }
+
+        REQUIRE_EQ(lhs.data(), 4);
+        REQUIRE_EQ(rhs.data(), 40);
+    }
+
+    SUBCASE("values are read-only through nodes and iterators")
+    {
+        hashed_tree gt = sample_tree();
+        auto root = gt.root();
+        static_assert(std::is_const_v<std::remove_reference_t<decltype(root.data())>>);
+        static_assert(std::is_const_v<std::remove_reference_t<decltype(*gt.preorder_begin())>>);
+        REQUIRE_THROWS_AS((void)hashed_tree::node().subtree_hash(), std::invalid_argument);
+    }
+}
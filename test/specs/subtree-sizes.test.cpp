@@ -0,0 +1,163 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+using sized_tree = general_tree<int, std::allocator<int>, tree_feature::subtree_sizes>;
+
+namespace
+{
+    // counts the descendants of every node by walking, to compare against the maintained sizes
+    std::size_t walk_count(sized_tree::node n)
+    {
+        std::size_t count = 0;
+        for (auto child = n.left_child(); !child.is_null(); child = child.right_sibling())
+            count += 1 + walk_count(child);
+        return count;
+    }
+
+    void check_sizes(sized_tree::node n)
+    {
+        REQUIRE_EQ(n.descendants_count(), walk_count(n));
+        for (auto child = n.left_child(); !child.is_null(); child = child.right_sibling())
+            check_sizes(child);
+    }
+}
+
+TEST_CASE("subtree sizes")
+{
+    SUBCASE("follow every kind of insertion")
+    {
+        sized_tree gt(0);
+        auto a = gt.insert_left_child(gt.root(), 1);
+        auto b = gt.insert_left_child(a, 2);
+        gt.insert_right_sibling(b, 3);
+        gt.insert_last_child(a, 4);
+
+        sized_tree other(5);
+        gt.insert_left_child(other.root(), 6);
+        gt.insert_right_sibling(a, other);
+
+        sized_tree other2(7);
+        other2.insert_last_child(other2.root(), 8);
+        gt.insert_last_child(b, other2);
+
+        sized_tree other3(9);
+        gt.insert_left_child(gt.root(), other3);
+
+        REQUIRE_EQ(gt.root().descendants_count(), 9);
+        REQUIRE_EQ(a.descendants_count(), 5);
+        check_sizes(gt.root());
+    }
+
+    SUBCASE("follow deletions")
+    {
+        sized_tree gt(0);
+        auto a = gt.insert_last_child(gt.root(), 1);
+        auto b = gt.insert_last_child(gt.root(), 2);
+        auto c = gt.insert_last_child(gt.root(), 3);
+        for (int i = 0; i < 4; i++)
+            gt.insert_last_child(b, i);
+        gt.insert_last_child(b.left_child(), 10);
+
+        gt.delete_node(b.left_child());
+        check_sizes(gt.root());
+        gt.delete_right_sibling(a);
+        check_sizes(gt.root());
+        REQUIRE_EQ(gt.root().descendants_count(), 2);
+        gt.delete_left_child(gt.root());
+        check_sizes(gt.root());
+        REQUIRE_EQ(gt.root().left_child(), c);
+        REQUIRE_EQ(gt.root().descendants_count(), 1);
+    }
+
+    SUBCASE("copies keep the sizes")
+    {
+        sized_tree gt(0);
+        auto a = gt.insert_last_child(gt.root(), 1);
+        gt.insert_last_child(a, 2);
+        gt.insert_last_child(gt.root(), 3);
+
+        sized_tree copy(gt);
+        check_sizes(copy.root());
+        REQUIRE_EQ(copy.root().descendants_count(), 3);
+    }
+
+    SUBCASE("random operations")
+    {
+        std::mt19937 rng(7);
+        sized_tree gt(0);
+        std::vector<sized_tree::node> nodes{gt.root()};
+        for (int i = 1; i < 500; i++)
+        {
+            auto target = nodes[rng() % nodes.size()];
+            switch (rng() % 3)
+            {
+            case 0:
+                nodes.push_back(gt.insert_left_child(target, i));
+                break;
+            case 1:
+                nodes.push_back(gt.insert_last_child(target, i));
+                break;
+            default:
+                if (!target.is_root())
+                    nodes.push_back(gt.insert_right_sibling(target, i));
+                break;
+            }
+        }
+        check_sizes(gt.root());
+
+        auto victim = gt.root().descendant_at(100);
+        gt.delete_node(victim);
+        check_sizes(gt.root());
+    }
+}
+
+TEST_CASE("descendant at")
+{
+    SUBCASE("throws for a null node")
+    {
+        sized_tree::node n;
+        REQUIRE_THROWS_AS((void)n.descendant_at(0), std::invalid_argument);
+    }
+
+    SUBCASE("visits the subtree in pre-order")
+    {
+        sized_tree gt(0);
+        general_tree<int> plain(0);
+        auto a = gt.insert_last_child(gt.root(), 1);
+        auto pa = plain.insert_last_child(plain.root(), 1);
+        gt.insert_last_child(a, 2);
+        plain.insert_last_child(pa, 2);
+        gt.insert_last_child(a, 3);
+        plain.insert_last_child(pa, 3);
+        gt.insert_last_child(gt.root(), 4);
+        plain.insert_last_child(plain.root(), 4);
+
+        std::vector<int> expected{0, 1, 2, 3, 4};
+        for (std::size_t i = 0; i < expected.size(); i++)
+        {
+            REQUIRE_EQ(gt.root().descendant_at(i).data(), expected[i]);
+            REQUIRE_EQ(plain.root().descendant_at(i).data(), expected[i]);
+        }
+        REQUIRE_EQ(a.descendant_at(2).data(), 3);
+        REQUIRE_EQ(pa.descendant_at(2).data(), 3);
+    }
+
+    SUBCASE("null out of range")
+    {
+        sized_tree gt(0);
+        general_tree<int> plain(0);
+        auto a = gt.insert_last_child(gt.root(), 1);
+        auto pa = plain.insert_last_child(plain.root(), 1);
+        gt.insert_last_child(gt.root(), 2);
+        plain.insert_last_child(plain.root(), 2);
+
+        REQUIRE(gt.root().descendant_at(3).is_null());
+        REQUIRE(plain.root().descendant_at(3).is_null());
+        REQUIRE(a.descendant_at(1).is_null());
+        REQUIRE(pa.descendant_at(1).is_null());
+    }
+}
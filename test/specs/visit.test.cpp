@@ -0,0 +1,114 @@
+#include "doctest.h"
+#include "general-tree.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // 1
+    // |-- 2
+    // |   |-- 5
+    // |   `-- 6
+    // |-- 3
+    // `-- 4
+    //     `-- 7
+    general_tree<int> sample_tree()
+    {
+        general_tree<int> gt(1);
+        auto n2 = gt.insert_last_child(gt.root(), 2);
+        gt.insert_last_child(n2, 5);
+        gt.insert_last_child(n2, 6);
+        gt.insert_last_child(gt.root(), 3);
+        auto n4 = gt.insert_last_child(gt.root(), 4);
+        gt.insert_last_child(n4, 7);
+        return gt;
+    }
+
+    template <visit_order Order>
+    std::vector<int> visited(const general_tree<int>& gt, general_tree<int>::node n)
+    {
+        std::vector<int> values;
+        gt.visit<Order>(n, [&](general_tree<int>::node current) { values.push_back(current.data()); });
+        return values;
+    }
+}
+
+TEST_CASE("visit")
+{
+    SUBCASE("matches the iterators in every order")
+    {
+        const auto gt = sample_tree();
+
+        const std::vector<int> preorder(gt.preorder_begin(), gt.preorder_end());
+        const std::vector<int> postorder(gt.postorder_begin(), gt.postorder_end());
+        const std::vector<int> level_order(gt.bfs_begin(), gt.bfs_end());
+        REQUIRE_EQ(visited<visit_order::preorder>(gt, gt.root()), preorder);
+        REQUIRE_EQ(visited<visit_order::postorder>(gt, gt.root()), postorder);
+        REQUIRE_EQ(visited<visit_order::level_order>(gt, gt.root()), level_order);
+    }
+
+    SUBCASE("stays inside the subtree")
+    {
+        const auto gt = sample_tree();
+        const auto n2 = gt.root().left_child();
+
+        const std::vector<int> preorder{2, 5, 6};
+        const std::vector<int> postorder{5, 6, 2};
+        const std::vector<int> leaf{7};
+        REQUIRE_EQ(visited<visit_order::preorder>(gt, n2), preorder);
+        REQUIRE_EQ(visited<visit_order::postorder>(gt, n2), postorder);
+        REQUIRE_EQ(visited<visit_order::level_order>(gt, n2), preorder);
+        REQUIRE_EQ(visited<visit_order::level_order>(gt, gt.root().last_child().left_child()), leaf);
+    }
+
+    SUBCASE("stops when the callback returns false")
+    {
+        const auto gt = sample_tree();
+        std::vector<int> values;
+        auto until_six = [&](general_tree<int>::node n) {
+            values.push_back(n.data());
+            return n.data() != 6;
+        };
+
+        REQUIRE_FALSE(gt.visit<visit_order::preorder>(gt.root(), until_six));
+        const std::vector<int> expected{1, 2, 5, 6};
+        REQUIRE_EQ(values, expected);
+
+        values.clear();
+        REQUIRE_FALSE(gt.visit<visit_order::level_order>(gt.root(), until_six));
+        REQUIRE_EQ(values.size(), 6);
+
+        REQUIRE(gt.visit<visit_order::postorder>(gt.root(), [](general_tree<int>::node) { return true; }));
+    }
+
+    SUBCASE("enter and leave hooks")
+    {
+        const auto gt = sample_tree();
+        std::string trace;
+        auto enter = [&](general_tree<int>::node n) { trace += "(" + std::to_string(n.data()); };
+        auto leave = [&](general_tree<int>::node) { trace += ")"; };
+
+        REQUIRE(gt.visit(gt.root(), enter, leave));
+        REQUIRE_EQ(trace, "(1(2(5)(6))(3)(4(7)))");
+
+        trace.clear();
+        REQUIRE(gt.visit(gt.root().left_child(), enter, leave));
+        REQUIRE_EQ(trace, "(2(5)(6))");
+
+        int left = 0;
+        REQUIRE_FALSE(gt.visit(gt.root(), [](general_tree<int>::node) {}, [&](general_tree<int>::node) {
+            return ++left < 3;
+        }));
+        REQUIRE_EQ(left, 3);
+    }
+
+    SUBCASE("values can be modified")
+    {
+        auto gt = sample_tree();
+        gt.visit<visit_order::postorder>(gt.root(), [](general_tree<int>::node n) { n.data() *= 10; });
+        REQUIRE_EQ(gt.root().last_child().left_child().data(), 70);
+        REQUIRE_THROWS_AS(gt.visit<visit_order::preorder>(general_tree<int>::node(), [](general_tree<int>::node) {}),
+                          std::invalid_argument);
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+
+struct AllocationCounter
+{
+    static inline unsigned allocate_calls;
+    static inline unsigned deallocate_calls;
+    static inline std::size_t live_bytes;
+
+    static void reset() noexcept
+    {
+        AllocationCounter::allocate_calls = 0;
+        AllocationCounter::deallocate_calls = 0;
+        AllocationCounter::live_bytes = 0;
+    }
+};
+
+template <typename T>
+class CountingAllocator
+{
+private:
+    int m_id = 0;
+
+    template <typename U>
+    friend class CountingAllocator;
+
+public:
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    explicit CountingAllocator(int id) noexcept : m_id(id) {}
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& rhs) noexcept : m_id(rhs.m_id)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        ++AllocationCounter::allocate_calls;
+        AllocationCounter::live_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        ++AllocationCounter::deallocate_calls;
+        AllocationCounter::live_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    [[nodiscard]] int id() const noexcept
+    {
+        return m_id;
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& rhs) const noexcept
+    {
+        return m_id == rhs.m_id;
+    }
+};
+
+struct AllocationCounterFixture
+{
+    AllocationCounterFixture()
+    {
+        AllocationCounter::reset();
+    }
+    ~AllocationCounterFixture() = default;
+};
@@ -0,0 +1,432 @@
+#pragma once
+
+#include "general-tree.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <streambuf>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Binary format, in order:
+ * - the 4 bytes "GTR1"
+ * - 0 for an empty tree, 1 otherwise, as a varint
+ * - every node in pre-order: its number of children as a varint, followed by its value as written by tree_codec<T>
+ *
+ * The tree ends once every node has got all of its children, so it can be read from a stream without a size.
+ *
+ * Varints store 7 bits per byte, least significant first, with the high bit set on every byte but the last.
+ */
+
+/**
+ * @brief Sink writing to the buffer of a std::ostream.
+ */
+class tree_stream_writer
+{
+private:
+    std::ostream& m_out;
+    std::streambuf* m_buffer;
+
+public:
+    explicit tree_stream_writer(std::ostream& out) noexcept : m_out(out), m_buffer(out.rdbuf()) {}
+
+    void write_bytes(const void* data, std::size_t size)
+    {
+        const auto count = static_cast<std::streamsize>(size);
+        if (m_buffer == nullptr || m_buffer->sputn(static_cast<const char*>(data), count) != count)
+            fail();
+    }
+
+    void write_varint(std::uint64_t value)
+    {
+        std::array<std::uint8_t, 10> bytes;
+        std::size_t size = 0;
+        for (; value >= 0x80; value >>= 7)
+            bytes[size++] = static_cast<std::uint8_t>(value | 0x80);
+        bytes[size++] = static_cast<std::uint8_t>(value);
+        write_bytes(bytes.data(), size);
+    }
+
+    void flush()
+    {
+        if (m_buffer->pubsync() == -1)
+            fail();
+    }
+
+private:
+    [[noreturn]] void fail()
+    {
+        m_out.setstate(std::ios_base::badbit);
+        throw std::runtime_error("Cannot write tree to stream");
+    }
+};
+
+/**
+ * @brief Sink appending to a byte vector.
+ */
+class tree_buffer_writer
+{
+private:
+    std::vector<std::byte>& m_out;
+
+public:
+    explicit tree_buffer_writer(std::vector<std::byte>& out) noexcept : m_out(out) {}
+
+    void write_bytes(const void* data, std::size_t size)
+    {
+        const auto* bytes = static_cast<const std::byte*>(data);
+        m_out.insert(m_out.end(), bytes, bytes + size);
+    }
+
+    void write_varint(std::uint64_t value)
+    {
+        for (; value >= 0x80; value >>= 7)
+            m_out.push_back(static_cast<std::byte>(value | 0x80));
+        m_out.push_back(static_cast<std::byte>(value));
+    }
+
+    void flush() noexcept {}
+};
+
+/**
+ * @brief Source reading from a byte buffer.
+ */
+class tree_buffer_reader
+{
+private:
+    const std::byte* m_current;
+    const std::byte* m_end;
+
+public:
+    explicit tree_buffer_reader(std::span<const std::byte> in) noexcept
+        : m_current(in.data()), m_end(in.data() + in.size())
+    {
+    }
+
+    void read_bytes(void* data, std::size_t size)
+    {
+        if (static_cast<std::size_t>(m_end - m_current) < size)
+            throw std::runtime_error("Truncated tree data");
+
+        std::memcpy(data, m_current, size);
+        m_current += size;
+    }
+
+    std::uint64_t read_varint()
+    {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            if (m_current == m_end)
+                throw std::runtime_error("Truncated tree data");
+
+            const auto byte = static_cast<std::uint8_t>(*m_current++);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        throw std::runtime_error("Malformed tree data");
+    }
+};
+
+/**
+ * @brief Source reading from the buffer of a std::istream, consuming exactly the bytes of the tree.
+ */
+class tree_stream_reader
+{
+private:
+    std::istream& m_in;
+    std::streambuf* m_buffer;
+
+public:
+    explicit tree_stream_reader(std::istream& in) noexcept : m_in(in), m_buffer(in.rdbuf()) {}
+
+    void read_bytes(void* data, std::size_t size)
+    {
+        const auto count = static_cast<std::streamsize>(size);
+        if (m_buffer == nullptr || m_buffer->sgetn(static_cast<char*>(data), count) != count)
+            truncated();
+    }
+
+    std::uint64_t read_varint()
+    {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            const auto c = m_buffer == nullptr ? std::char_traits<char>::eof() : m_buffer->sbumpc();
+            if (c == std::char_traits<char>::eof())
+                truncated();
+
+            const auto byte = static_cast<std::uint8_t>(c);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        throw std::runtime_error("Malformed tree data");
+    }
+
+private:
+    [[noreturn]] void truncated()
+    {
+        m_in.setstate(std::ios_base::eofbit | std::ios_base::failbit);
+        throw std::runtime_error("Truncated tree data");
+    }
+};
+
+/**
+ * @brief Encodes and decodes values of type T. Specialize it for types which are not trivially copyable.
+ *
+ * A codec provides encode(writer, value) and decode(reader) as static templates over the writer and reader types,
+ * which offer write_bytes / write_varint and read_bytes / read_varint.
+ */
+template <typename T, typename = void>
+struct tree_codec;
+
+/**
+ * @brief Trivially copyable values are copied as they are laid out in memory, so data is only portable between
+ * machines sharing the same representation of T.
+ */
+template <typename T>
+struct tree_codec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>>
+{
+    template <typename Writer>
+    static void encode(Writer& out, const T& value)
+    {
+        out.write_bytes(&value, sizeof(T));
+    }
+
+    template <typename Reader>
+    static T decode(Reader& in)
+    {
+        std::array<std::byte, sizeof(T)> bytes;
+        in.read_bytes(bytes.data(), sizeof(T));
+        return std::bit_cast<T>(bytes);
+    }
+};
+
+template <>
+struct tree_codec<std::string>
+{
+    template <typename Writer>
+    static void encode(Writer& out, const std::string& value)
+    {
+        out.write_varint(value.size());
+        out.write_bytes(value.data(), value.size());
+    }
+
+    // - the length is not trusted, the string grows one chunk at a time as its bytes are read, so a corrupt length
+    //   fails as truncated data instead of being allocated up front
+    template <typename Reader>
+    static std::string decode(Reader& in)
+    {
+        constexpr std::size_t chunk = 64 * 1024;
+        const std::uint64_t size = in.read_varint();
+
+        std::string value;
+        while (value.size() < size)
+        {
+            const std::size_t offset = value.size();
+            const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(chunk, size - offset));
+            value.resize(offset + count);
+            in.read_bytes(value.data() + offset, count);
+        }
+        return value;
+    }
+};
+
+/**
+ * @brief Writes the tree through any writer offering write_bytes, write_varint and flush.
+ */
+template <typename Writer, typename T, typename Allocator, tree_feature Features,
+          typename Augmentation>
+    requires requires(Writer& out) { out.write_varint(std::uint64_t()); }
+void serialize(const general_tree<T, Allocator, Features, Augmentation>& tree, Writer& out)
+{
+    out.write_bytes("GTR1", 4);
+    out.write_varint(tree.empty() ? 0 : 1);
+
+    for (auto it = tree.preorder_begin(); it != tree.preorder_end(); ++it)
+    {
+        out.write_varint(it.get_node().children_count());
+        tree_codec<T>::encode(out, *it);
+    }
+
+    out.flush();
+}
+
+/**
+ * @brief Writes the tree to the given stream.
+ * @throws std::runtime_error If the stream fails.
+ */
+template <typename T, typename Allocator, tree_feature Features, typename Augmentation>
+void serialize(const general_tree<T, Allocator, Features, Augmentation>& tree, std::ostream& out)
+{
+    tree_stream_writer writer(out);
+    serialize(tree, writer);
+}
+
+/**
+ * @brief Appends the tree to the given buffer.
+ */
+template <typename T, typename Allocator, tree_feature Features, typename Augmentation>
+void serialize(const general_tree<T, Allocator, Features, Augmentation>& tree,
+               std::vector<std::byte>& out)
+{
+    tree_buffer_writer writer(out);
+    serialize(tree, writer);
+}
+
+/**
+ * @brief Input range decoding the nodes of a serialized tree, as (depth, value) pairs in pre-order.
+ *
+ * The header is read on construction and every increment reads one more node, so the range can be handed to
+ * general_tree::from_preorder_depths() to build the tree as the data is read. The range ends after the last node of
+ * the tree, without reading past it.
+ */
+template <typename T, typename Reader>
+class tree_decoder
+{
+private:
+    Reader& m_in;
+
+    // children still to be read for every node on the path from the root to the current node
+    std::vector<std::uint64_t> m_pending;
+    std::optional<std::pair<std::size_t, T>> m_current;
+
+public:
+    class iterator
+    {
+    private:
+        tree_decoder* m_decoder;
+
+    public:
+        using value_type = std::pair<std::size_t, T>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept : m_decoder(nullptr) {}
+        explicit iterator(tree_decoder* decoder) noexcept : m_decoder(decoder) {}
+
+        // - hands out the current value, an iterator can only be dereferenced once per node
+        value_type operator*() const
+        {
+            return std::move(*m_decoder->m_current);
+        }
+
+        iterator& operator++()
+        {
+            m_decoder->next();
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const noexcept
+        {
+            return !m_decoder->m_current.has_value();
+        }
+    };
+
+    /**
+     * @throws std::runtime_error If the header or the root is truncated or malformed.
+     */
+    explicit tree_decoder(Reader& in) : m_in(in)
+    {
+        char magic[4];
+        m_in.read_bytes(magic, sizeof(magic));
+        if (std::memcmp(magic, "GTR1", sizeof(magic)) != 0)
+            throw std::runtime_error("Malformed tree data");
+
+        const std::uint64_t not_empty = m_in.read_varint();
+        if (not_empty > 1)
+            throw std::runtime_error("Malformed tree data");
+        if (not_empty == 1)
+            read();
+    }
+
+    [[nodiscard]] iterator begin() noexcept
+    {
+        return iterator(this);
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const noexcept
+    {
+        return std::default_sentinel;
+    }
+
+private:
+    void read()
+    {
+        const std::size_t depth = m_pending.size();
+        m_pending.push_back(m_in.read_varint());
+        m_current.emplace(depth, tree_codec<T>::decode(m_in));
+    }
+
+    void next()
+    {
+        while (!m_pending.empty() && m_pending.back() == 0)
+            m_pending.pop_back();
+
+        if (m_pending.empty())
+        {
+            m_current.reset();
+            return;
+        }
+
+        --m_pending.back();
+        read();
+    }
+};
+
+/**
+ * @brief Builds a tree in one pass from any reader offering read_bytes and read_varint.
+ *
+ * The nodes are linked as they are read and the bookkeeping selected by the features of the tree is computed once at
+ * the end, in O(n) overall.
+ *
+ * @throws std::runtime_error If the data is truncated or malformed.
+ */
+template <typename Tree, typename Reader>
+    requires requires(Reader& in) { in.read_varint(); }
+Tree deserialize(Reader& in, const typename Tree::allocator_type& allocator = typename Tree::allocator_type())
+{
+    tree_decoder<typename Tree::value_type, Reader> nodes(in);
+    return Tree::from_preorder_depths(nodes, allocator);
+}
+
+/**
+ * @brief Builds a tree from the given stream, consuming it as the tree is built.
+ * @throws std::runtime_error If the data is truncated or malformed.
+ */
+template <typename Tree>
+Tree deserialize(std::istream& in, const typename Tree::allocator_type& allocator = typename Tree::allocator_type())
+{
+    tree_stream_reader reader(in);
+    return deserialize<Tree>(reader, allocator);
+}
+
+/**
+ * @brief Builds a tree from the given buffer.
+ * @throws std::runtime_error If the data is truncated or malformed.
+ */
+template <typename Tree>
+Tree deserialize(std::span<const std::byte> in,
+                 const typename Tree::allocator_type& allocator = typename Tree::allocator_type())
+{
+    tree_buffer_reader reader(in);
+    return deserialize<Tree>(reader, allocator);
+}
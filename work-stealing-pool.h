@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Fixed set of threads running fork-join jobs, each worker with its own task deque.
+ *
+ * A worker pushes and pops the tasks it spawns at the back of its deque, so it keeps working on the most recent
+ * (and usually smallest, cache-warm) piece of work, while idle workers steal from the front of the others' deques,
+ * taking the oldest and usually largest pieces. Workers without anything to run or steal sleep until a task is
+ * spawned.
+ *
+ * This is the executor expected by the parallel algorithms of general_tree.
+ */
+class work_stealing_pool
+{
+public:
+    class worker;
+    using task = std::function<void(worker&)>;
+
+    /**
+     * @brief Execution context handed to every task, identifying the worker thread running it.
+     */
+    class worker
+    {
+    private:
+        work_stealing_pool* m_pool;
+        std::size_t m_index;
+        std::mutex m_mutex;
+        std::deque<task> m_tasks;
+        friend class work_stealing_pool;
+
+    public:
+        worker(work_stealing_pool* pool, std::size_t index) noexcept : m_pool(pool), m_index(index) {}
+
+        /**
+         * @brief Position of the worker in the pool, in the range [0, concurrency()).
+         */
+        [[nodiscard]] std::size_t index() const noexcept
+        {
+            return m_index;
+        }
+
+        /**
+         * @brief Queues a task on this worker, to be run by it or stolen by an idle one.
+         *
+         * The job being run does not finish before every task spawned from it has run.
+         */
+        template <typename F>
+        void spawn(F&& f)
+        {
+            m_pool->m_pending.fetch_add(1);
+            try
+            {
+                m_pool->push(*this, task(std::forward<F>(f)));
+            }
+            catch (...)
+            {
+                m_pool->m_pending.fetch_sub(1);
+                throw;
+            }
+        }
+
+        /**
+         * @brief Checks whether there are more idle workers than queued tasks, which makes splitting work worth it.
+         */
+        [[nodiscard]] bool hungry() const noexcept
+        {
+            return m_pool->m_idle.load(std::memory_order_relaxed) > m_pool->m_queued.load(std::memory_order_relaxed);
+        }
+    };
+
+private:
+    std::vector<std::unique_ptr<worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep;
+    std::atomic<std::size_t> m_queued{0};
+    std::atomic<std::size_t> m_idle{0};
+    bool m_stopping = false;
+
+    std::mutex m_run_mutex;
+    std::mutex m_done_mutex;
+    std::condition_variable m_done;
+    std::atomic<std::size_t> m_pending{0};
+    std::exception_ptr m_error;
+
+public:
+    /**
+     * @brief Starts the given number of worker threads, at least one.
+     */
+    explicit work_stealing_pool(std::size_t threads = std::thread::hardware_concurrency())
+    {
+        threads = std::max<std::size_t>(threads, 1);
+        m_workers.reserve(threads);
+        for (std::size_t i = 0; i < threads; i++)
+            m_workers.push_back(std::make_unique<worker>(this, i));
+
+        m_threads.reserve(threads);
+        try
+        {
+            for (std::size_t i = 0; i < threads; i++)
+                m_threads.emplace_back([this, i] { work(*m_workers[i]); });
+        }
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    ~work_stealing_pool()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Number of worker threads.
+     */
+    [[nodiscard]] std::size_t concurrency() const noexcept
+    {
+        return m_workers.size();
+    }
+
+    /**
+     * @brief Runs f(worker&) on one of the workers and blocks until it and every task spawned from it have run.
+     *
+     * Jobs are run one at a time. The first exception thrown by any of the tasks is rethrown once all of them
+     * have finished.
+     */
+    template <typename F>
+    void run(F&& f)
+    {
+        std::lock_guard<std::mutex> run_lock(m_run_mutex);
+        m_error = nullptr;
+        m_pending.store(1);
+        push(*m_workers.front(), task([&f](worker& w) { f(w); }));
+
+        {
+            std::unique_lock<std::mutex> lock(m_done_mutex);
+            m_done.wait(lock, [this] { return m_pending.load() == 0; });
+        }
+
+        if (m_error)
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+
+private:
+    void push(worker& w, task t)
+    {
+        {
+            std::lock_guard<std::mutex> lock(w.m_mutex);
+            w.m_tasks.push_back(std::move(t));
+            m_queued.fetch_add(1);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        }
+        m_sleep.notify_one();
+    }
+
+    // - own tasks are taken from the back, stolen ones from the front
+    bool take(worker& self, task& t)
+    {
+        for (std::size_t i = 0; i < m_workers.size(); i++)
+        {
+            worker& victim = *m_workers[(self.m_index + i) % m_workers.size()];
+            std::lock_guard<std::mutex> lock(victim.m_mutex);
+            if (victim.m_tasks.empty())
+                continue;
+
+            if (&victim == &self)
+            {
+                t = std::move(victim.m_tasks.back());
+                victim.m_tasks.pop_back();
+            }
+            else
+            {
+                t = std::move(victim.m_tasks.front());
+                victim.m_tasks.pop_front();
+            }
+            m_queued.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    void execute(worker& self, task& t)
+    {
+        try
+        {
+            t(self);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_done_mutex);
+            if (!m_error)
+                m_error = std::current_exception();
+        }
+        t = nullptr;
+
+        if (m_pending.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(m_done_mutex);
+            m_done.notify_all();
+        }
+    }
+
+    void work(worker& self)
+    {
+        task t;
+        while (true)
+        {
+            if (take(self, t))
+            {
+                execute(self, t);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_idle.fetch_add(1);
+            m_sleep.wait(lock, [this] { return m_stopping || m_queued.load() != 0; });
+            m_idle.fetch_sub(1);
+
+            if (m_stopping && m_queued.load() == 0)
+                return;
+        }
+    }
+
+    void stop() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_stopping = true;
+        }
+        m_sleep.notify_all();
+
+        for (std::thread& thread : m_threads)
+            thread.join();
+        m_threads.clear();
+    }
+};